@@ -0,0 +1,75 @@
+#include <string>
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#include "benchmark/benchmark.h"
+
+#include "FileManager.h"
+
+using namespace file_manager::size_literals;
+
+/// @brief One pass scan of 64 MiB file in 1 MiB chunks. Argument is ReadFileHandle::AccessPattern. residentMiB counter is file data left in page cache after scan
+static void oneShotScan(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("access_pattern_benchmark.bin");
+	file_manager::ReadFileHandle::AccessPattern accessPattern = static_cast<file_manager::ReadFileHandle::AccessPattern>(state.range(0));
+	const size_t size = 64_mib;
+	double residentMiB = 0;
+
+	manager.writeBinaryFile
+	(
+		fileName,
+		[size](file_manager::WriteBinaryFileHandle& handle)
+		{
+			handle.setDurability(file_manager::WriteFileHandle::Durability::dataSync);
+			handle.write(std::string(size, 'a'));
+		}
+	);
+
+	for (auto _ : state)
+	{
+		manager.readBinaryFile
+		(
+			fileName,
+			[accessPattern](file_manager::ReadBinaryFileHandle& handle)
+			{
+				std::string chunk;
+
+				handle.setAccessPattern(accessPattern);
+
+				while (handle.readSome(chunk, 1_mib))
+				{
+					benchmark::DoNotOptimize(chunk.data());
+				}
+			}
+		);
+	}
+
+#ifdef __LINUX__
+	size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	std::vector<unsigned char> pages(size / pageSize);
+	int descriptor = open(fileName.c_str(), O_RDONLY);
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+	mincore(mapping, size, pages.data());
+	munmap(mapping, size);
+	close(descriptor);
+
+	for (unsigned char page : pages)
+	{
+		residentMiB += page & 1;
+	}
+
+	residentMiB = residentMiB * pageSize / 1_mib;
+#endif
+
+	state.SetBytesProcessed(state.iterations() * size);
+	state.counters["residentMiB"] = residentMiB;
+}
+
+BENCHMARK(oneShotScan)->DenseRange(0, 4)->Unit(benchmark::kMillisecond);
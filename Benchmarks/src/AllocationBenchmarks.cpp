@@ -0,0 +1,150 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "FileManager.h"
+
+static std::atomic_size_t allocations = 0;
+
+/// @brief Replacement operators pair through these, so pointer from malloc always reaches free. Not inlined, otherwise GCC matches free against operator new and warns
+#ifdef __LINUX__
+[[gnu::noinline]]
+#else
+__declspec(noinline)
+#endif
+static void* allocate(size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+
+	if (void* result = std::malloc(size ? size : 1))
+	{
+		return result;
+	}
+
+	throw std::bad_alloc();
+}
+
+#ifdef __LINUX__
+[[gnu::noinline]]
+#else
+__declspec(noinline)
+#endif
+static void deallocate(void* data) noexcept
+{
+	std::free(data);
+}
+
+void* operator new(size_t size)
+{
+	return allocate(size);
+}
+
+void* operator new[](size_t size)
+{
+	return allocate(size);
+}
+
+void operator delete(void* data) noexcept
+{
+	deallocate(data);
+}
+
+void operator delete[](void* data) noexcept
+{
+	deallocate(data);
+}
+
+void operator delete(void* data, size_t) noexcept
+{
+	deallocate(data);
+}
+
+void operator delete[](void* data, size_t) noexcept
+{
+	deallocate(data);
+}
+
+static const std::filesystem::path allocationBenchmarkFile("allocation_benchmark.txt");
+
+static void setAllocationsCounter(benchmark::State& state, size_t allocationsBefore)
+{
+	state.counters["allocations"] = benchmark::Counter(static_cast<double>(allocations - allocationsBefore), benchmark::Counter::kAvgIterations);
+}
+
+/// @brief Uncontended waiting read
+static void readAllocations(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::string data(128, 'a');
+
+	{
+		std::ofstream(allocationBenchmarkFile) << data;
+	}
+
+	size_t allocationsBefore = allocations;
+
+	for (auto _ : state)
+	{
+		manager.readFile
+		(
+			allocationBenchmarkFile,
+			[&data](file_manager::ReadTextFileHandle& handle)
+			{
+				handle.readSome(data, data.size(), false, false);
+			}
+		);
+	}
+
+	setAllocationsCounter(state, allocationsBefore);
+}
+
+/// @brief Queued appends completed through futures
+static void appendAllocations(benchmark::State& state)
+{
+	constexpr size_t batchSize = 256;
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::vector<std::future<void>> futures;
+
+	futures.reserve(batchSize);
+
+	size_t allocationsBefore = allocations;
+
+	for (auto _ : state)
+	{
+		futures.emplace_back
+		(
+			manager.appendFile
+			(
+				allocationBenchmarkFile,
+				[](file_manager::AppendFileHandle& handle)
+				{
+					handle.write("1");
+				},
+				false
+			)
+		);
+
+		if (futures.size() == batchSize)
+		{
+			for (std::future<void>& future : futures)
+			{
+				future.wait();
+			}
+
+			futures.clear();
+		}
+	}
+
+	for (std::future<void>& future : futures)
+	{
+		future.wait();
+	}
+
+	setAllocationsCounter(state, allocationsBefore);
+}
+
+BENCHMARK(readAllocations);
+BENCHMARK(appendAllocations);
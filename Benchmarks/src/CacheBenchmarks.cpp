@@ -0,0 +1,103 @@
+#include <format>
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+#include "benchmark/benchmark.h"
+
+#include "FileManager.h"
+
+using namespace file_manager::size_literals;
+
+static constexpr size_t files = 1000;
+static const size_t fileSize = 1_kib;
+static constexpr size_t traceSize = 100000;
+
+static const std::vector<std::filesystem::path>& createFiles()
+{
+	static std::vector<std::filesystem::path> result;
+
+	if (result.empty())
+	{
+		std::string data(fileSize, 'a');
+
+		for (size_t i = 0; i < files; i++)
+		{
+			std::filesystem::path& filePath = result.emplace_back(std::format("cache_benchmark{}.txt", i));
+
+			if (!std::filesystem::exists(filePath) || std::filesystem::file_size(filePath) != fileSize)
+			{
+				std::ofstream(filePath, std::ios_base::binary) << data;
+			}
+		}
+	}
+
+	return result;
+}
+
+/// @brief File indices where probability of rank i is proportional to 1 / i^skew
+static std::vector<size_t> zipfianTrace(double skew)
+{
+	std::vector<double> weights(files);
+	std::vector<size_t> ranks(files);
+	std::mt19937_64 random(42);
+
+	for (size_t i = 0; i < files; i++)
+	{
+		weights[i] = 1.0 / std::pow(static_cast<double>(i + 1), skew);
+		ranks[i] = i;
+	}
+
+	// Popularity doesn't follow file order
+	std::shuffle(ranks.begin(), ranks.end(), random);
+
+	std::discrete_distribution<size_t> distribution(weights.begin(), weights.end());
+	std::vector<size_t> result(traceSize);
+
+	for (size_t& index : result)
+	{
+		index = ranks[distribution(random)];
+	}
+
+	return result;
+}
+
+/// @brief Hit ratio of cache holding 10% of files. First argument is Cache::EvictionPolicy, second is Zipf skew in percent
+static void zipfianHitRatio(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	file_manager::Cache& cache = manager.getCache();
+	const std::vector<std::filesystem::path>& filePaths = createFiles();
+	std::vector<size_t> trace = zipfianTrace(state.range(1) / 100.0);
+	size_t hits = 0;
+
+	cache.clear();
+	cache.setEvictionPolicy(static_cast<file_manager::Cache::EvictionPolicy>(state.range(0)));
+	cache.setCacheSize(files / 10 * fileSize);
+
+	for (auto _ : state)
+	{
+		for (size_t index : trace)
+		{
+			hits += cache.contains(filePaths[index]);
+
+			manager.readBinaryFile
+			(
+				filePaths[index],
+				[](file_manager::ReadBinaryFileHandle& handle)
+				{
+					benchmark::DoNotOptimize(handle.readAllData());
+				}
+			);
+		}
+	}
+
+	state.counters["hitRatio"] = static_cast<double>(hits) / (state.iterations() * traceSize);
+	state.SetItemsProcessed(state.iterations() * traceSize);
+
+	cache.clear();
+	cache.setCacheSize(0);
+	cache.setEvictionPolicy(file_manager::Cache::EvictionPolicy::windowTinyLfu);
+}
+
+BENCHMARK(zipfianHitRatio)->ArgsProduct({ { 0, 1 }, { 60, 80, 100, 120 } })->Iterations(1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,153 @@
+#include <format>
+
+#include "benchmark/benchmark.h"
+
+#include "FileManager.h"
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace file_manager::size_literals;
+
+static std::filesystem::path createFile(size_t size)
+{
+	std::filesystem::path filePath(std::format("direct_io_benchmark{}.bin", size));
+
+	if (!std::filesystem::exists(filePath) || std::filesystem::file_size(filePath) != size)
+	{
+		std::ofstream file(filePath, std::ios_base::binary);
+		std::string chunk(std::min<size_t>(size, 1_mib), 'a');
+
+		for (size_t written = 0; written < size; written += chunk.size())
+		{
+			file.write(chunk.data(), std::min(chunk.size(), size - written));
+		}
+	}
+
+	return filePath;
+}
+
+/// @brief Drop file pages from page cache
+static void evictFile(const std::filesystem::path& filePath)
+{
+#ifdef __LINUX__
+	int descriptor = open(filePath.c_str(), O_RDONLY);
+
+	if (descriptor != -1)
+	{
+		fdatasync(descriptor);
+		posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+
+		close(descriptor);
+	}
+#endif
+}
+
+static void prepareIteration(benchmark::State& state, const std::filesystem::path& filePath)
+{
+	state.PauseTiming();
+
+	if (!state.range(1))
+	{
+		evictFile(filePath);
+	}
+
+	state.ResumeTiming();
+}
+
+/// @brief readBinaryFile through std::fstream. Arguments are file size and 1 for warm page cache or 0 for cold
+static void readStream(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::filesystem::path filePath = createFile(state.range(0));
+
+	manager.getCache().setCacheSize(0);
+
+	for (auto _ : state)
+	{
+		prepareIteration(state, filePath);
+
+		manager.readBinaryFile
+		(
+			filePath,
+			[](file_manager::ReadBinaryFileHandle& handle)
+			{
+				benchmark::DoNotOptimize(handle.readAllData());
+			}
+		);
+	}
+
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+/// @brief readDirectFile bypassing page cache. Arguments are file size and 1 for warm page cache or 0 for cold
+static void readDirect(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::filesystem::path filePath = createFile(state.range(0));
+
+	for (auto _ : state)
+	{
+		prepareIteration(state, filePath);
+
+		manager.readDirectFile
+		(
+			filePath,
+			[](file_manager::DirectReadFileHandle& handle)
+			{
+				benchmark::DoNotOptimize(handle.readAllData());
+			}
+		);
+	}
+
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+/// @brief writeBinaryFile through std::fstream. Argument is file size
+static void writeStream(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::string data(state.range(0), 'a');
+
+	for (auto _ : state)
+	{
+		manager.writeBinaryFile
+		(
+			"direct_io_benchmark_write.bin",
+			[&data](file_manager::WriteBinaryFileHandle& handle)
+			{
+				handle.write(data);
+			}
+		);
+	}
+
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+/// @brief writeDirectFile bypassing page cache. Argument is file size
+static void writeDirect(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::string data(state.range(0), 'a');
+
+	for (auto _ : state)
+	{
+		manager.writeDirectFile
+		(
+			"direct_io_benchmark_write.bin",
+			[&data](file_manager::DirectWriteFileHandle& handle)
+			{
+				handle.write(data);
+			}
+		);
+	}
+
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(readStream)->ArgsProduct({ { static_cast<int64_t>(64_mib), static_cast<int64_t>(1_gib) }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+BENCHMARK(readDirect)->ArgsProduct({ { static_cast<int64_t>(64_mib), static_cast<int64_t>(1_gib) }, { 0, 1 } })->Unit(benchmark::kMillisecond);
+BENCHMARK(writeStream)->Arg(64_mib)->Arg(1_gib)->Unit(benchmark::kMillisecond);
+BENCHMARK(writeDirect)->Arg(64_mib)->Arg(1_gib)->Unit(benchmark::kMillisecond);
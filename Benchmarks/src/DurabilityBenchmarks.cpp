@@ -0,0 +1,49 @@
+#include <vector>
+
+#include "benchmark/benchmark.h"
+
+#include "FileManager.h"
+
+/// @brief 64 concurrent durable appends to one file. Argument is WriteFileHandle::Durability
+static void durableAppends(benchmark::State& state)
+{
+	constexpr size_t appends = 64;
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	file_manager::WriteFileHandle::Durability durability = static_cast<file_manager::WriteFileHandle::Durability>(state.range(0));
+	std::vector<std::future<void>> futures;
+
+	futures.reserve(appends);
+
+	std::filesystem::remove("durability_benchmark.txt");
+
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < appends; i++)
+		{
+			futures.push_back
+			(
+				manager.appendFile
+				(
+					"durability_benchmark.txt",
+					[durability](file_manager::AppendFileHandle& handle)
+					{
+						handle.setDurability(durability);
+						handle.write("timestamp=1700000000 level=info message=request completed\n");
+					},
+					false
+				)
+			);
+		}
+
+		for (std::future<void>& future : futures)
+		{
+			future.get();
+		}
+
+		futures.clear();
+	}
+
+	state.SetItemsProcessed(state.iterations() * appends);
+}
+
+BENCHMARK(durableAppends)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
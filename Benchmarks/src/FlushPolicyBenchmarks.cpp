@@ -0,0 +1,56 @@
+#include "benchmark/benchmark.h"
+
+#include "FileManager.h"
+
+/// @brief Append 10k small records in one request. Argument is FlushPolicy::Type
+static void appendRecords(benchmark::State& state)
+{
+	constexpr size_t records = 10'000;
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	file_manager::WriteFileHandle::FlushPolicy flushPolicy;
+	const std::string record("timestamp=1700000000 level=info message=request completed\n");
+
+	switch (static_cast<file_manager::WriteFileHandle::FlushPolicy::Type>(state.range(0)))
+	{
+	case file_manager::WriteFileHandle::FlushPolicy::Type::bytes:
+		flushPolicy = file_manager::WriteFileHandle::FlushPolicy::everyBytes(64 * 1024);
+
+		break;
+
+	case file_manager::WriteFileHandle::FlushPolicy::Type::interval:
+		flushPolicy = file_manager::WriteFileHandle::FlushPolicy::every(std::chrono::milliseconds(10));
+
+		break;
+
+	case file_manager::WriteFileHandle::FlushPolicy::Type::onClose:
+		flushPolicy = file_manager::WriteFileHandle::FlushPolicy::onClose();
+
+		break;
+
+	default:
+		break;
+	}
+
+	std::filesystem::remove("flush_policy_benchmark.txt");
+
+	for (auto _ : state)
+	{
+		manager.appendFile
+		(
+			"flush_policy_benchmark.txt",
+			[&](file_manager::AppendFileHandle& handle)
+			{
+				handle.setFlushPolicy(flushPolicy);
+
+				for (size_t i = 0; i < records; i++)
+				{
+					handle.write(record);
+				}
+			}
+		);
+	}
+
+	state.SetItemsProcessed(state.iterations() * records);
+}
+
+BENCHMARK(appendRecords)->DenseRange(0, 3)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,45 @@
+#include <format>
+#include <vector>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+
+#include "FileManager.h"
+
+inline constexpr size_t totalPaths = 4096;
+
+static const std::vector<std::filesystem::path>& getPaths()
+{
+	static const std::vector<std::filesystem::path> paths = []()
+		{
+			std::vector<std::filesystem::path> result;
+
+			result.reserve(totalPaths);
+
+			for (size_t i = 0; i < totalPaths; i++)
+			{
+				result.emplace_back(std::format("nodes_benchmark/shard_{}/file_{}.txt", i % 64, i));
+			}
+
+			return result;
+		}();
+
+	return paths;
+}
+
+/// @brief addFile without existence check only resolves path in NodesContainer, so this measures lookup throughput
+static void lookup(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::vector<std::filesystem::path>& paths = getPaths();
+	size_t index = static_cast<size_t>(state.thread_index()) * 7919;
+
+	for (auto _ : state)
+	{
+		manager.addFile(paths[index++ % totalPaths], false);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(lookup)->ThreadRange(1, std::max<int>(std::thread::hardware_concurrency(), 1))->UseRealTime();
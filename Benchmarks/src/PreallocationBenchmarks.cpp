@@ -0,0 +1,34 @@
+#include "benchmark/benchmark.h"
+
+#include "FileManager.h"
+
+using namespace file_manager::size_literals;
+
+/// @brief Small log record appends. Argument is preallocation step, 0 disables preallocation
+static void preallocatedAppends(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("preallocation_benchmark.log");
+
+	std::filesystem::remove(fileName);
+
+	manager.setPreallocation(fileName, static_cast<uint64_t>(state.range(0)));
+
+	for (auto _ : state)
+	{
+		manager.appendFile
+		(
+			fileName,
+			[](file_manager::AppendFileHandle& handle)
+			{
+				handle.write("timestamp=1700000000 level=info message=request completed\n");
+			}
+		);
+	}
+
+	manager.setPreallocation(fileName, 0);
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(preallocatedAppends)->Arg(0)->Arg(64_kib)->Arg(1_mib);
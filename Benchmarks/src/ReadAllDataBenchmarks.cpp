@@ -0,0 +1,73 @@
+#include <sstream>
+#include <format>
+
+#include "benchmark/benchmark.h"
+
+#include "FileManager.h"
+
+using namespace file_manager::size_literals;
+
+static std::filesystem::path createFile(size_t size)
+{
+	std::filesystem::path filePath(std::format("read_all_data_benchmark{}.txt", size));
+
+	if (!std::filesystem::exists(filePath) || std::filesystem::file_size(filePath) != size)
+	{
+		std::ofstream file(filePath, std::ios_base::binary);
+		std::string chunk(std::min<size_t>(size, 1_mib), 'a');
+
+		for (size_t written = 0; written < size; written += chunk.size())
+		{
+			file.write(chunk.data(), std::min(chunk.size(), size - written));
+		}
+	}
+
+	return filePath;
+}
+
+/// @brief Previous readAllData implementation: copy through std::ostringstream. Argument is file size
+static void readAllDataStream(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::filesystem::path filePath = createFile(state.range(0));
+
+	for (auto _ : state)
+	{
+		manager.readFile
+		(
+			filePath,
+			[](file_manager::ReadTextFileHandle& handle)
+			{
+				benchmark::DoNotOptimize((std::ostringstream() << handle.getStream().rdbuf()).str());
+			}
+		);
+	}
+
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+/// @brief readAllData with sized read. Argument is file size
+static void readAllDataSized(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::filesystem::path filePath = createFile(state.range(0));
+
+	manager.getCache().setCacheSize(0);
+
+	for (auto _ : state)
+	{
+		manager.readFile
+		(
+			filePath,
+			[](file_manager::ReadTextFileHandle& handle)
+			{
+				benchmark::DoNotOptimize(handle.readAllData());
+			}
+		);
+	}
+
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(readAllDataStream)->RangeMultiplier(8)->Range(4_kib, 1_gib)->Unit(benchmark::kMicrosecond);
+BENCHMARK(readAllDataSized)->RangeMultiplier(8)->Range(4_kib, 1_gib)->Unit(benchmark::kMicrosecond);
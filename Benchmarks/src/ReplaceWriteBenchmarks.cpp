@@ -0,0 +1,75 @@
+#include <vector>
+#include <thread>
+#include <atomic>
+
+#include "benchmark/benchmark.h"
+
+#include "FileManager.h"
+
+using namespace file_manager::size_literals;
+
+/// @brief Rewrite 1 MiB file that is read continuously by 2 threads. Argument is 0 for writeBinaryFile and 1 for replaceBinaryFile
+static void rewriteUnderReaders(benchmark::State& state)
+{
+	constexpr size_t readersCount = 2;
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("replace_benchmark.bin");
+	const std::string data(1_mib, 'a');
+	bool isReplace = state.range(0);
+	std::atomic_bool isRunning = true;
+	std::atomic_uint64_t reads = 0;
+	std::vector<std::thread> readers;
+
+	std::ofstream(fileName, std::ios_base::binary) << data;
+
+	for (size_t i = 0; i < readersCount; i++)
+	{
+		readers.emplace_back
+		(
+			[&]()
+			{
+				while (isRunning)
+				{
+					manager.readPositionalFile
+					(
+						fileName,
+						[](file_manager::PositionalReadFileHandle& handle)
+						{
+							benchmark::DoNotOptimize(handle.readAllData());
+						}
+					);
+
+					reads++;
+				}
+			}
+		);
+	}
+
+	for (auto _ : state)
+	{
+		auto write = [&data](file_manager::WriteFileHandle& handle)
+			{
+				handle.write(data);
+			};
+
+		if (isReplace)
+		{
+			manager.replaceBinaryFile(fileName, write);
+		}
+		else
+		{
+			manager.writeBinaryFile(fileName, write);
+		}
+	}
+
+	isRunning = false;
+
+	for (std::thread& reader : readers)
+	{
+		reader.join();
+	}
+
+	state.counters["reads"] = benchmark::Counter(static_cast<double>(reads), benchmark::Counter::kIsRate);
+}
+
+BENCHMARK(rewriteUnderReaders)->DenseRange(0, 1)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,125 @@
+#include <vector>
+#include <thread>
+#include <format>
+
+#include "benchmark/benchmark.h"
+
+#include "FileManager.h"
+
+static const std::filesystem::path appendBenchmarkFile("append_benchmark.txt");
+
+/// @brief Many threads append to single file without waiting, measures enqueue cost on contended FileNode
+static void appendSubmit(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::vector<std::future<void>> futures;
+
+	futures.reserve(state.max_iterations);
+
+	for (auto _ : state)
+	{
+		futures.emplace_back
+		(
+			manager.appendFile
+			(
+				appendBenchmarkFile,
+				[](std::unique_ptr<file_manager::WriteFileHandle>&& handle)
+				{
+					handle->write("1");
+				},
+				false
+			)
+		);
+	}
+
+	for (std::future<void>& future : futures)
+	{
+		future.wait();
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+/// @brief Many threads append to single file and wait for each append. Argument is FileManager::DispatchMode
+static void appendRoundTrip(benchmark::State& state)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+
+	if (!state.thread_index())
+	{
+		manager.setDispatchMode(static_cast<file_manager::FileManager::DispatchMode>(state.range(0)));
+	}
+
+	for (auto _ : state)
+	{
+		manager.appendFile
+		(
+			appendBenchmarkFile,
+			[](std::unique_ptr<file_manager::WriteFileHandle>&& handle)
+			{
+				handle->write("1");
+			}
+		);
+	}
+
+	state.SetItemsProcessed(state.iterations());
+}
+
+/// @brief Read many small files and wait for all of them. Argument is 0 for separate readFile calls and 1 for single submitBatch
+static void readManyFiles(benchmark::State& state)
+{
+	constexpr size_t files = 1024;
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::vector<std::filesystem::path> filePaths;
+	std::vector<std::future<void>> futures;
+	std::vector<file_manager::BatchRequest> requests;
+
+	filePaths.reserve(files);
+	futures.reserve(files);
+	requests.reserve(files);
+
+	for (size_t i = 0; i < files; i++)
+	{
+		std::ofstream(filePaths.emplace_back(std::format("read_many_benchmark{}.txt", i))) << "data";
+	}
+
+	auto callback = [](file_manager::ReadTextFileHandle& handle)
+		{
+			benchmark::DoNotOptimize(handle.getFileName());
+		};
+
+	for (auto _ : state)
+	{
+		if (state.range(0))
+		{
+			for (const std::filesystem::path& filePath : filePaths)
+			{
+				requests.push_back(file_manager::BatchRequest::create<file_manager::ReadTextFileHandle>(filePath, callback));
+			}
+
+			manager.submitBatch(requests).wait();
+
+			requests.clear();
+		}
+		else
+		{
+			for (const std::filesystem::path& filePath : filePaths)
+			{
+				futures.push_back(manager.readFile(filePath, callback, false));
+			}
+
+			for (std::future<void>& future : futures)
+			{
+				future.wait();
+			}
+
+			futures.clear();
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * files);
+}
+
+BENCHMARK(appendSubmit)->ThreadRange(1, std::max<int>(std::thread::hardware_concurrency(), 1))->UseRealTime()->Iterations(20'000);
+BENCHMARK(appendRoundTrip)->DenseRange(0, 2)->ThreadRange(1, std::max<int>(std::thread::hardware_concurrency(), 1))->UseRealTime();
+BENCHMARK(readManyFiles)->DenseRange(0, 1)->UseRealTime();
@@ -0,0 +1,86 @@
+#include <vector>
+#include <format>
+
+#include "gtest/gtest.h"
+
+#include "FileManager.h"
+#include "Exceptions/FileDoesNotExistException.h"
+
+TEST(FileManager, SubmitBatch)
+{
+	constexpr size_t files = 256;
+	constexpr size_t appendsPerFile = 4;
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::vector<file_manager::BatchRequest> requests;
+	std::vector<std::string> data(files);
+
+	for (size_t i = 0; i < files; i++)
+	{
+		requests.push_back
+		(
+			file_manager::BatchRequest::create<file_manager::WriteTextFileHandle>
+			(
+				std::format("batch_test{}.txt", i),
+				[](file_manager::WriteTextFileHandle&)
+				{
+
+				}
+			)
+		);
+
+		for (size_t j = 0; j < appendsPerFile; j++)
+		{
+			requests.push_back
+			(
+				file_manager::BatchRequest::create<file_manager::AppendFileHandle>
+				(
+					std::format("batch_test{}.txt", i),
+					[i](file_manager::AppendFileHandle& handle)
+					{
+						handle.write(std::to_string(i));
+					}
+				)
+			);
+		}
+	}
+
+	manager.submitBatch(requests).get();
+
+	requests.clear();
+
+	for (size_t i = 0; i < files; i++)
+	{
+		requests.push_back
+		(
+			file_manager::BatchRequest::create<file_manager::ReadTextFileHandle>
+			(
+				std::format("batch_test{}.txt", i),
+				[&data, i](file_manager::ReadTextFileHandle& handle)
+				{
+					data[i] = handle.readAllData();
+				}
+			)
+		);
+	}
+
+	manager.submitBatch(requests).get();
+
+	for (size_t i = 0; i < files; i++)
+	{
+		std::string expected;
+
+		for (size_t j = 0; j < appendsPerFile; j++)
+		{
+			expected += std::to_string(i);
+		}
+
+		ASSERT_EQ(data[i], expected);
+	}
+
+	requests.clear();
+
+	requests.push_back(file_manager::BatchRequest::create<file_manager::ReadTextFileHandle>("./batch_missing_file.txt", [](file_manager::ReadFileHandle&) {}));
+	requests.push_back(file_manager::BatchRequest::create<file_manager::ReadTextFileHandle>("batch_test0.txt", [](file_manager::ReadFileHandle&) {}));
+
+	ASSERT_THROW(manager.submitBatch(requests).get(), file_manager::exceptions::FileDoesNotExistException);
+}
@@ -0,0 +1,146 @@
+#include <format>
+
+#include "gtest/gtest.h"
+
+#include "FileManager.h"
+#include "Exceptions/FileDoesNotExistException.h"
+
+static constexpr size_t fileSize = 1000;
+
+static std::string cacheFileName(size_t index)
+{
+	return std::format("cache_test{}.txt", index);
+}
+
+static std::string readCached(size_t index)
+{
+	std::string result;
+
+	file_manager::FileManager::getInstance().readFile
+	(
+		cacheFileName(index),
+		[&result](file_manager::ReadTextFileHandle& handle)
+		{
+			result = handle.readAllData();
+		}
+	);
+
+	return result;
+}
+
+TEST(FileManager, CacheEviction)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	file_manager::Cache& cache = manager.getCache();
+	constexpr size_t files = 12;
+
+	for (size_t i = 0; i < files; i++)
+	{
+		std::ofstream(cacheFileName(i)) << std::string(fileSize, static_cast<char>('a' + i));
+	}
+
+	cache.clear();
+	cache.setEvictionPolicy(file_manager::Cache::EvictionPolicy::lru);
+	cache.setCacheSize(3 * fileSize);
+
+	for (size_t i = 0; i < 4; i++)
+	{
+		ASSERT_EQ(readCached(i), std::string(fileSize, static_cast<char>('a' + i)));
+	}
+
+	// Full cache evicts least recently used file instead of rejecting new one
+	ASSERT_FALSE(cache.contains(cacheFileName(0)));
+	ASSERT_EQ(cache.getCurrentCacheSize(), 3 * fileSize);
+
+	readCached(1);
+	readCached(4);
+
+	ASSERT_TRUE(cache.contains(cacheFileName(1)));
+	ASSERT_FALSE(cache.contains(cacheFileName(2)));
+	ASSERT_TRUE(cache.contains(cacheFileName(4)));
+
+	cache.setCacheSize(fileSize);
+
+	ASSERT_TRUE(cache.contains(cacheFileName(4)));
+	ASSERT_EQ(cache.getCurrentCacheSize(), fileSize);
+
+	// Main space of 10 files behind window smaller than one file
+	cache.clear();
+	cache.setEvictionPolicy(file_manager::Cache::EvictionPolicy::windowTinyLfu);
+	cache.setCacheSize(11 * fileSize);
+
+	for (size_t repeat = 0; repeat < 4; repeat++)
+	{
+		for (size_t i = 0; i < files - 2; i++)
+		{
+			readCached(i);
+		}
+	}
+
+	for (size_t i = 0; i < files - 2; i++)
+	{
+		ASSERT_TRUE(cache.contains(cacheFileName(i)));
+	}
+
+	// One-time access doesn't displace frequently used files, but data is still read
+	ASSERT_EQ(readCached(files - 1), std::string(fileSize, static_cast<char>('a' + files - 1)));
+	ASSERT_FALSE(cache.contains(cacheFileName(files - 1)));
+	ASSERT_LE(cache.getCurrentCacheSize(), cache.getCacheSize());
+
+	size_t reads = 1;
+
+	while (!cache.contains(cacheFileName(files - 1)) && reads < 20)
+	{
+		readCached(files - 1);
+
+		reads++;
+	}
+
+	// File becomes hot and is admitted
+	ASSERT_GT(reads, 1);
+	ASSERT_TRUE(cache.contains(cacheFileName(files - 1)));
+	ASSERT_EQ(cache.getCurrentCacheSize(), 10 * fileSize);
+
+	cache.clear();
+	cache.setCacheSize(0);
+
+	ASSERT_EQ(cache.getCurrentCacheSize(), 0);
+}
+
+TEST(FileManager, RemoveCachedFile)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	file_manager::Cache& cache = manager.getCache();
+	constexpr size_t index = 100;
+
+	std::ofstream(cacheFileName(index)) << "removed";
+
+	cache.clear();
+	cache.setCacheSize(2 * fileSize);
+
+	ASSERT_EQ(readCached(index), "removed");
+	ASSERT_TRUE(cache.contains(cacheFileName(index)));
+
+	std::shared_ptr<const std::string> removedData = cache.getCacheData(cacheFileName(index));
+
+	manager.removeFile(cacheFileName(index));
+
+	ASSERT_FALSE(std::filesystem::exists(cacheFileName(index)));
+	ASSERT_FALSE(cache.contains(cacheFileName(index)));
+	ASSERT_THROW(cache.getCacheData(cacheFileName(index)), file_manager::exceptions::FileDoesNotExistException);
+
+	// Data taken before remove outlives its entry
+	ASSERT_EQ(*removedData, "removed");
+
+	// File recreated outside of FileManager is read from disk
+	std::ofstream(cacheFileName(index)) << "recreated";
+
+	ASSERT_EQ(readCached(index), "recreated");
+
+	manager.removeFile(cacheFileName(index));
+
+	cache.clear();
+	cache.setCacheSize(0);
+
+	ASSERT_EQ(cache.getCurrentCacheSize(), 0);
+}
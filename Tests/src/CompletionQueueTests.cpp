@@ -0,0 +1,130 @@
+#include <vector>
+#include <array>
+
+#include "gtest/gtest.h"
+
+#include "FileManager.h"
+
+TEST(FileManager, CompletionQueue)
+{
+	constexpr size_t writes = 1024;
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("completion_queue_test.txt");
+	file_manager::CompletionQueue completionQueue;
+	std::array<file_manager::CompletionQueue::Completion, 64> completions;
+	std::vector<bool> isCompleted(writes + 2);
+	size_t completed = 0;
+
+	{
+		std::ofstream file(fileName);
+	}
+
+	for (size_t i = 0; i < writes; i++)
+	{
+		manager.submitRequest<file_manager::AppendFileHandle>
+		(
+			fileName,
+			[](file_manager::AppendFileHandle& handle)
+			{
+				handle.write("12");
+			},
+			completionQueue,
+			i
+		);
+	}
+
+	manager.submitRequest<file_manager::ReadTextFileHandle>
+	(
+		"./completion_queue_missing_file.txt",
+		[](file_manager::ReadTextFileHandle&)
+		{
+
+		},
+		completionQueue,
+		writes
+	);
+
+	manager.submitRequest<file_manager::ReadTextFileHandle>
+	(
+		fileName,
+		[](file_manager::ReadTextFileHandle&)
+		{
+			throw std::runtime_error("failed");
+		},
+		completionQueue,
+		writes + 1
+	);
+
+	while (completed != isCompleted.size())
+	{
+		size_t count = completionQueue.wait(completions);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const file_manager::CompletionQueue::Completion& completion = completions[i];
+
+			ASSERT_FALSE(isCompleted[completion.userTag]);
+
+			isCompleted[completion.userTag] = true;
+
+			if (completion.userTag == writes)
+			{
+				ASSERT_EQ(completion.status, file_manager::CompletionQueue::Status::fileDoesNotExist);
+			}
+			else if (completion.userTag == writes + 1)
+			{
+				ASSERT_EQ(completion.status, file_manager::CompletionQueue::Status::failed);
+			}
+			else
+			{
+				ASSERT_EQ(completion.status, file_manager::CompletionQueue::Status::success);
+				ASSERT_EQ(completion.bytes, 2);
+			}
+		}
+
+		completed += count;
+	}
+
+	ASSERT_EQ(completionQueue.poll(completions), 0);
+	ASSERT_EQ(std::filesystem::file_size(fileName), writes * 2);
+}
+
+#ifdef __LINUX__
+#include <poll.h>
+
+TEST(FileManager, CompletionQueueEventDescriptor)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("completion_queue_event_test.txt");
+	file_manager::CompletionQueue completionQueue;
+	std::array<file_manager::CompletionQueue::Completion, 4> completions;
+	pollfd descriptor = { completionQueue.getEventDescriptor(), POLLIN, 0 };
+
+	ASSERT_EQ(poll(&descriptor, 1, 0), 0);
+
+	for (uint64_t i = 0; i < completions.size(); i++)
+	{
+		manager.submitRequest<file_manager::WriteTextFileHandle>
+		(
+			fileName,
+			[](file_manager::WriteTextFileHandle& handle)
+			{
+				handle.write("data");
+			},
+			completionQueue,
+			i
+		);
+	}
+
+	size_t completed = 0;
+
+	while (completed != completions.size())
+	{
+		ASSERT_EQ(poll(&descriptor, 1, 5000), 1);
+
+		completed += completionQueue.poll(std::span(completions).subspan(completed));
+	}
+
+	ASSERT_EQ(poll(&descriptor, 1, 0), 0);
+}
+#endif
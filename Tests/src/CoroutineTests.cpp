@@ -0,0 +1,135 @@
+#include <coroutine>
+#include <future>
+#include <vector>
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "FileManager.h"
+#include "Exceptions/FileDoesNotExistException.h"
+
+/// @brief Minimal eagerly started coroutine that reports completion through std::future
+struct Task
+{
+	struct promise_type
+	{
+		std::promise<void> completion;
+
+		Task get_return_object()
+		{
+			return Task{ completion.get_future() };
+		}
+
+		std::suspend_never initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		std::suspend_never final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_void()
+		{
+			completion.set_value();
+		}
+
+		void unhandled_exception()
+		{
+			completion.set_exception(std::current_exception());
+		}
+	};
+
+	std::future<void> completion;
+};
+
+static Task appendSession(const std::string& fileName, size_t writes, std::thread::id callerId, bool& isResumedOnCaller)
+{
+	for (size_t i = 0; i < writes; i++)
+	{
+		co_await file_manager::FileManager::getInstance().asyncAppend(fileName, "1");
+
+		if (std::this_thread::get_id() == callerId)
+		{
+			isResumedOnCaller = true;
+		}
+	}
+}
+
+static Task readSession(const std::string& fileName, std::string& data)
+{
+	data = co_await file_manager::FileManager::getInstance().asyncRead(fileName);
+
+	co_await file_manager::FileManager::getInstance().asyncRequest<file_manager::ReadBinaryFileHandle>
+	(
+		fileName,
+		[](file_manager::ReadBinaryFileHandle& handle)
+		{
+			return handle.getFileSize();
+		}
+	);
+}
+
+static void runSessions(const std::string& fileName)
+{
+	constexpr size_t sessions = 64;
+	constexpr size_t writes = 32;
+	std::vector<Task> tasks;
+	std::string data;
+	bool isResumedOnCaller = false;
+
+	file_manager::FileManager::getInstance().writeFile
+	(
+		fileName,
+		[](file_manager::WriteTextFileHandle&)
+		{
+
+		}
+	);
+
+	tasks.reserve(sessions);
+
+	for (size_t i = 0; i < sessions; i++)
+	{
+		tasks.push_back(appendSession(fileName, writes, std::this_thread::get_id(), isResumedOnCaller));
+	}
+
+	for (Task& task : tasks)
+	{
+		task.completion.get();
+	}
+
+	readSession(fileName, data).completion.get();
+
+	ASSERT_FALSE(isResumedOnCaller);
+	ASSERT_EQ(data.size(), sessions * writes);
+	ASSERT_THROW(readSession("./coroutine_missing_file.txt", data).completion.get(), file_manager::exceptions::FileDoesNotExistException);
+}
+
+TEST(FileManager, Coroutines)
+{
+	runSessions("coroutine_test.txt");
+}
+
+#ifdef __LINUX__
+TEST(FileManager, CoroutinesIoUring)
+{
+	using namespace file_manager::size_literals;
+
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	std::string data(3_mib, 'a');
+
+	manager.setIoBackend(file_manager::FileManager::IoBackend::ioUring);
+
+	runSessions("coroutine_io_uring_test.txt");
+
+	[&manager, &data]() -> Task
+	{
+		EXPECT_EQ(co_await manager.asyncWrite("coroutine_io_uring_big_test.txt", data), data.size());
+		EXPECT_EQ(co_await manager.asyncRead("coroutine_io_uring_big_test.txt"), data);
+	}().completion.get();
+
+	manager.setIoBackend(file_manager::FileManager::IoBackend::threadPool);
+}
+#endif
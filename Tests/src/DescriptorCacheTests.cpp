@@ -0,0 +1,85 @@
+#include <format>
+
+#include "gtest/gtest.h"
+
+#include "FileManager.h"
+#include "Exceptions/FileDoesNotExistException.h"
+
+static std::string readPositional(const std::string& fileName)
+{
+	std::string result;
+
+	file_manager::FileManager::getInstance().readPositionalFile
+	(
+		fileName,
+		[&result](file_manager::PositionalReadFileHandle& handle)
+		{
+			result = handle.readAllData();
+		}
+	);
+
+	return result;
+}
+
+TEST(FileManager, DescriptorCache)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	file_manager::DescriptorCache& descriptorCache = manager.getDescriptorCache();
+	size_t previousLimit = descriptorCache.getLimit();
+	constexpr size_t files = 3;
+
+	ASSERT_GT(previousLimit, 0);
+
+	descriptorCache.clear();
+	descriptorCache.setLimit(files - 1);
+
+	for (size_t i = 0; i < files; i++)
+	{
+		std::string fileName = std::format("descriptor_cache_test{}.txt", i);
+
+		std::ofstream(fileName) << fileName;
+
+		ASSERT_EQ(readPositional(fileName), fileName);
+	}
+
+	ASSERT_EQ(descriptorCache.size(), files - 1);
+
+	// Cached descriptor is reused
+	ASSERT_EQ(readPositional("descriptor_cache_test2.txt"), "descriptor_cache_test2.txt");
+	ASSERT_EQ(descriptorCache.size(), files - 1);
+
+	// External replacement is detected
+	std::ofstream("descriptor_cache_test_replacement.txt") << "replaced";
+	std::filesystem::rename("descriptor_cache_test_replacement.txt", "descriptor_cache_test2.txt");
+
+	ASSERT_EQ(readPositional("descriptor_cache_test2.txt"), "replaced");
+
+	manager.removeFile("descriptor_cache_test2.txt");
+
+	ASSERT_EQ(descriptorCache.size(), files - 2);
+	ASSERT_THROW(readPositional("descriptor_cache_test2.txt"), file_manager::exceptions::FileDoesNotExistException);
+
+	// Stream handles take descriptors from cache too
+	descriptorCache.clear();
+	descriptorCache.setLimit(files);
+
+	for (size_t i = 0; i < 2; i++)
+	{
+		std::string data;
+
+		manager.writeFile("descriptor_cache_test0.txt", [](file_manager::WriteFileHandle& handle) { handle.write("written"); });
+		manager.appendFile("descriptor_cache_test0.txt", [](file_manager::WriteFileHandle& handle) { handle.write(" appended"); });
+		manager.readFile("descriptor_cache_test0.txt", [&data](file_manager::ReadFileHandle& handle) { data = handle.readAllData(); });
+
+		ASSERT_EQ(data, "written appended");
+		ASSERT_EQ(descriptorCache.size(), 3);
+	}
+
+	descriptorCache.setLimit(0);
+
+	ASSERT_EQ(descriptorCache.size(), 0);
+
+	descriptorCache.setLimit(previousLimit);
+
+	ASSERT_EQ(descriptorCache.getLimit(), previousLimit);
+}
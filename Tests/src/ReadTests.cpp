@@ -1,7 +1,15 @@
+#include <algorithm>
 #include <random>
 #include <thread>
 #include <format>
 #include <unordered_map>
+#include <vector>
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
 
 #include "gtest/gtest.h"
 
@@ -142,3 +150,277 @@ TEST(FileManager, MultipleRead)
 		ASSERT_EQ(totalSizes.at(fileName), data.size());
 	}
 }
+
+TEST(FileManager, SynchronousRead)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("synchronous_read_test.txt");
+	std::thread::id callbackThreadId;
+
+	{
+		std::ofstream(fileName) << "data";
+	}
+
+	std::future<void> result = manager.readFile
+	(
+		fileName,
+		[&callbackThreadId](std::unique_ptr<file_manager::ReadFileHandle>&& handle)
+		{
+			callbackThreadId = std::this_thread::get_id();
+
+			ASSERT_EQ(handle->readAllData(), "data");
+		}
+	);
+
+	// Future of request completed on calling thread is ready, so waiting on it doesn't throw future_error
+	ASSERT_TRUE(result.valid());
+	ASSERT_EQ(result.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+	ASSERT_NO_THROW(result.get());
+	ASSERT_EQ(callbackThreadId, std::this_thread::get_id());
+
+	std::future<void> failed = manager.readFile
+	(
+		fileName,
+		[](std::unique_ptr<file_manager::ReadFileHandle>&&)
+		{
+			throw std::runtime_error("synchronous read failure");
+		}
+	);
+
+	ASSERT_THROW(failed.get(), std::runtime_error);
+}
+
+TEST(FileManager, MappedRead)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("mapped_read_test.txt");
+	const std::string emptyFileName("mapped_read_empty_test.txt");
+	std::string data(1'000'000, '\0');
+
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		data[i] = static_cast<char>('a' + i % 26);
+	}
+
+	{
+		std::ofstream(fileName, std::ios_base::binary) << data;
+		std::ofstream emptyFile(emptyFileName);
+	}
+
+	manager.readMappedFile
+	(
+		fileName,
+		[&data](file_manager::MappedFileHandle& handle)
+		{
+			handle.advise(file_manager::MappedFileHandle::Advice::random, 4097, 100);
+
+			ASSERT_EQ(handle.getView(), data);
+			ASSERT_EQ(handle.getData().size(), data.size());
+		}
+	);
+
+	manager.readMappedFile
+	(
+		emptyFileName,
+		[](file_manager::MappedFileHandle& handle)
+		{
+			ASSERT_TRUE(handle.getView().empty());
+		}
+	);
+}
+
+TEST(FileManager, PositionalRead)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("positional_read_test.txt");
+	constexpr size_t readers = 64;
+	constexpr size_t chunkSize = 4096;
+	std::string data(readers * chunkSize, '\0');
+	std::vector<std::future<void>> requests;
+
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		data[i] = static_cast<char>('a' + i % 26);
+	}
+
+	std::ofstream(fileName, std::ios_base::binary) << data;
+
+	for (size_t i = 0; i < readers; i++)
+	{
+		requests.push_back
+		(
+			manager.readPositionalFile
+			(
+				fileName,
+				[&data, i](file_manager::PositionalReadFileHandle& handle)
+				{
+					ASSERT_EQ(handle.readData(i * chunkSize, chunkSize), data.substr(i * chunkSize, chunkSize));
+					ASSERT_EQ(handle.readData(data.size() - 10, chunkSize), data.substr(data.size() - 10));
+				},
+				false
+			)
+		);
+	}
+
+	for (std::future<void>& request : requests)
+	{
+		request.get();
+	}
+
+	manager.writeFile
+	(
+		fileName,
+		[](file_manager::WriteTextFileHandle& handle)
+		{
+			handle.write("updated");
+		}
+	);
+
+	manager.readPositionalFile
+	(
+		fileName,
+		[](file_manager::PositionalReadFileHandle& handle)
+		{
+			ASSERT_EQ(handle.readAllData(), "updated");
+			ASSERT_EQ(handle.getTransferredBytes(), 7);
+		}
+	);
+}
+
+#ifdef __LINUX__
+/// @brief Part of file pages that are in page cache
+static double residentPart(const std::string& fileName)
+{
+	size_t size = std::filesystem::file_size(fileName);
+	size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	std::vector<unsigned char> pages((size + pageSize - 1) / pageSize);
+	int descriptor = open(fileName.c_str(), O_RDONLY);
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+	mincore(mapping, size, pages.data());
+	munmap(mapping, size);
+	close(descriptor);
+
+	return static_cast<double>(std::ranges::count_if(pages, [](unsigned char page) { return page & 1; })) / pages.size();
+}
+#endif
+
+TEST(FileManager, AccessPattern)
+{
+	using AccessPattern = file_manager::ReadFileHandle::AccessPattern;
+
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("access_pattern_test.bin");
+	constexpr size_t chunkSize = 1024 * 1024;
+	std::string data(8 * chunkSize, '\0');
+	std::mt19937_64 random(42);
+
+	for (char& character : data)
+	{
+		character = static_cast<char>(random());
+	}
+
+	// Dirty pages can't be dropped
+	manager.writeBinaryFile
+	(
+		fileName,
+		[&data](file_manager::WriteBinaryFileHandle& handle)
+		{
+			handle.setDurability(file_manager::WriteFileHandle::Durability::dataSync);
+			handle.write(data);
+		}
+	);
+
+	manager.readBinaryFile
+	(
+		fileName,
+		[&data](file_manager::ReadBinaryFileHandle& handle)
+		{
+			std::string result;
+
+			handle.readSome(result, 10);
+
+			// Stream keeps its position
+			handle.setAccessPattern(AccessPattern::random);
+
+			ASSERT_EQ(handle.getAccessPattern(), AccessPattern::random);
+
+			handle.readSome(result, 10);
+
+			ASSERT_EQ(result, data.substr(10, 10));
+
+			handle.getStream().seekg(5 * chunkSize + 3);
+			handle.readSome(result, 100);
+
+			ASSERT_EQ(result, data.substr(5 * chunkSize + 3, 100));
+			ASSERT_EQ(handle.getStream().seekg(0, std::ios_base::end).tellg(), data.size());
+
+			handle.getStream().seekg(0);
+
+			ASSERT_EQ(handle.readAllData(), data);
+		}
+	);
+
+	manager.readBinaryFile
+	(
+		fileName,
+		[&data](file_manager::ReadBinaryFileHandle& handle)
+		{
+			std::string result;
+			std::string chunk;
+
+			handle.setAccessPattern(AccessPattern::dontNeed);
+
+			while (handle.readSome(chunk, chunkSize - 1))
+			{
+				result += chunk;
+			}
+
+			ASSERT_EQ(result, data);
+		}
+	);
+
+#ifdef __LINUX__
+	ASSERT_LT(residentPart(fileName), 0.5);
+#endif
+
+	manager.readBinaryFile
+	(
+		fileName,
+		[&data](file_manager::ReadBinaryFileHandle& handle)
+		{
+			handle.setAccessPattern(AccessPattern::willNeed);
+
+			ASSERT_EQ(handle.readAllData(), data);
+		}
+	);
+
+#ifdef __LINUX__
+	ASSERT_GT(residentPart(fileName), 0.5);
+#endif
+
+	file_manager::Cache& cache = manager.getCache();
+
+	cache.clear();
+	cache.setCacheSize(2 * data.size());
+
+	// File read into cache goes through hinted request stream
+	manager.readBinaryFile
+	(
+		fileName,
+		[&data](file_manager::ReadBinaryFileHandle& handle)
+		{
+			handle.setAccessPattern(AccessPattern::dontNeed);
+
+			ASSERT_EQ(handle.readAllData(), data);
+		}
+	);
+
+	ASSERT_TRUE(cache.contains(fileName));
+#ifdef __LINUX__
+	ASSERT_LT(residentPart(fileName), 0.5);
+#endif
+
+	cache.clear();
+	cache.setCacheSize(0);
+}
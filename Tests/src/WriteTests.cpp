@@ -1,11 +1,18 @@
 #include <vector>
 #include <thread>
+#include <latch>
+#include <format>
+
+#ifdef __LINUX__
+#include <sys/stat.h>
+#endif
 
 #include "gtest/gtest.h"
 
 #include "FileManager.h"
 
 using namespace std::chrono_literals;
+using namespace file_manager::size_literals;
 
 inline constexpr int threadsCount = 8;
 inline constexpr int writes = 512;
@@ -157,3 +164,517 @@ TEST(FileManager, MultipleFilesWrite)
 		ASSERT_EQ(count, totalWrites);
 	}
 }
+
+TEST(FileManager, TypedHandles)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("typed_handles_test.bin");
+	const std::string binaryData("line\r\nline\0", 11);
+	std::vector<std::future<void>> futures;
+	std::string data;
+
+	manager.writeBinaryFile
+	(
+		fileName,
+		[&binaryData](file_manager::WriteBinaryFileHandle& handle)
+		{
+			static_assert(file_manager::WriteBinaryFileHandle::openMode & std::ios_base::binary);
+
+			handle.write(binaryData);
+		}
+	);
+
+	for (size_t i = 0; i < writes; i++)
+	{
+		futures.emplace_back
+		(
+			manager.appendBinaryFile
+			(
+				fileName,
+				[&binaryData](file_manager::WriteFileHandle& handle)
+				{
+					handle.write(binaryData);
+				},
+				false
+			)
+		);
+	}
+
+	for (std::future<void>& future : futures)
+	{
+		future.wait();
+	}
+
+	manager.readBinaryFile
+	(
+		fileName,
+		[&data](file_manager::ReadBinaryFileHandle& handle)
+		{
+			data = handle.readAllData();
+		}
+	);
+
+	ASSERT_EQ(data.size(), binaryData.size() * (writes + 1));
+	ASSERT_EQ(data.substr(0, binaryData.size()), binaryData);
+}
+
+TEST(FileManager, DirectWriteRead)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("direct_write_read_test.bin");
+	std::string data(5_mib + 123, '\0');
+	std::string result;
+
+	for (size_t i = 0; i < data.size(); i++)
+	{
+		data[i] = static_cast<char>(i * 31 % 251);
+	}
+
+	manager.writeDirectFile
+	(
+		fileName,
+		[&data](file_manager::DirectWriteFileHandle& handle)
+		{
+			constexpr size_t chunkSize = 1000;
+
+			handle.write(std::string_view(data).substr(0, 10));
+
+			// Padded tail is rewritten by following writes
+			handle.flush();
+
+			for (size_t offset = 10; offset < data.size(); offset += chunkSize)
+			{
+				handle.write(std::string_view(data).substr(offset, chunkSize));
+			}
+		}
+	);
+
+	ASSERT_EQ(std::filesystem::file_size(fileName), data.size());
+	ASSERT_EQ((std::ostringstream() << std::ifstream(fileName, std::ios_base::binary).rdbuf()).str(), data);
+
+	manager.readDirectFile
+	(
+		fileName,
+		[&data, &result](file_manager::DirectReadFileHandle& handle)
+		{
+			std::string head(7, '\0');
+
+			ASSERT_EQ(handle.read(std::as_writable_bytes(std::span<char>(head))), head.size());
+
+			result = head + handle.readAllData();
+
+			ASSERT_EQ(handle.getTransferredBytes(), data.size());
+		}
+	);
+
+	ASSERT_EQ(result, data);
+}
+
+TEST(FileManager, VectoredWrite)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("vectored_write_test.txt");
+	const std::string payload(100'000, 'p');
+	std::string expected;
+
+	manager.writeFile
+	(
+		fileName,
+		[&payload](file_manager::WriteTextFileHandle& handle)
+		{
+			std::vector<std::string_view> record = { "header;", payload, ";trailer\n" };
+
+			handle.write(record);
+			handle.write({ "header;", "small", ";trailer\n" });
+
+			ASSERT_EQ(handle.getTransferredBytes(), 2 * (7 + 9) + payload.size() + 5);
+		}
+	);
+
+	expected = "header;" + payload + ";trailer\nheader;small;trailer\n";
+
+	ASSERT_EQ((std::ostringstream() << std::ifstream(fileName).rdbuf()).str(), expected);
+
+	file_manager::Cache& cache = manager.getCache();
+	std::vector<std::string> pieces;
+
+	cache.clear();
+	cache.setCacheSize(1_mib);
+
+	for (size_t i = 0; i < 3000; i++)
+	{
+		pieces.push_back(std::to_string(i) + ';');
+	}
+
+	// More pieces than one vectored write takes, cached data follows file
+	manager.writeFile
+	(
+		fileName,
+		[&pieces](file_manager::WriteTextFileHandle& handle)
+		{
+			std::vector<std::string_view> views(pieces.begin(), pieces.end());
+
+			handle.write({ "small;" });
+			handle.write(views);
+		}
+	);
+
+	expected = "small;";
+
+	for (const std::string& piece : pieces)
+	{
+		expected += piece;
+	}
+
+	ASSERT_EQ((std::ostringstream() << std::ifstream(fileName).rdbuf()).str(), expected);
+	ASSERT_EQ(*cache.getCacheData(fileName), expected);
+
+	cache.clear();
+	cache.setCacheSize(0);
+}
+
+TEST(FileManager, FlushPolicy)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	file_manager::Cache& cache = manager.getCache();
+	const std::string fileName("flush_policy_test.txt");
+	const std::string record("0123456789");
+	constexpr size_t records = 1000;
+
+	manager.setWriteBufferSize(64_kib);
+	cache.setCacheSize(1_mib);
+
+	manager.writeFile
+	(
+		fileName,
+		[&](file_manager::WriteTextFileHandle& handle)
+		{
+			handle.setFlushPolicy(file_manager::WriteFileHandle::FlushPolicy::onClose());
+
+			for (size_t i = 0; i < records; i++)
+			{
+				handle.write(record);
+			}
+
+			ASSERT_EQ(std::filesystem::file_size(fileName), 0);
+
+			handle.flush();
+
+			ASSERT_EQ(std::filesystem::file_size(fileName), records * record.size());
+
+			handle.setFlushPolicy(file_manager::WriteFileHandle::FlushPolicy::everyBytes(100));
+			handle.write(std::string(99, 'a'));
+
+			ASSERT_EQ(std::filesystem::file_size(fileName), records * record.size());
+
+			handle.write("b");
+
+			ASSERT_EQ(std::filesystem::file_size(fileName), records * record.size() + 100);
+
+			handle.setFlushPolicy(file_manager::WriteFileHandle::FlushPolicy::perCall());
+			handle.write({ record, record });
+
+			ASSERT_EQ(std::filesystem::file_size(fileName), (records + 2) * record.size() + 100);
+		}
+	);
+
+	std::string expected;
+
+	for (size_t i = 0; i < records; i++)
+	{
+		expected += record;
+	}
+
+	expected += std::string(99, 'a') + 'b' + record + record;
+
+	ASSERT_EQ((std::ostringstream() << std::ifstream(fileName).rdbuf()).str(), expected);
+	ASSERT_TRUE(cache.contains(fileName));
+	ASSERT_EQ(*cache.getCacheData(fileName), expected);
+	ASSERT_EQ(cache.getCurrentCacheSize(), expected.size());
+
+	cache.clear();
+	cache.setCacheSize(0);
+	manager.setWriteBufferSize(0);
+}
+
+TEST(FileManager, ConcurrentCachedWrites)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	file_manager::Cache& cache = manager.getCache();
+	std::vector<std::thread> threads;
+	std::latch start(threadsCount);
+
+	cache.clear();
+	cache.setCacheSize(16_kib);
+
+	for (int i = 0; i < threadsCount; i++)
+	{
+		threads.emplace_back
+		(
+			[&manager, &start, i]()
+			{
+				start.arrive_and_wait();
+
+				for (size_t j = 0; j < writes; j++)
+				{
+					// Some writes don't fit into cache and drop their reservation
+					manager.writeFile
+					(
+						std::format("concurrent_cache_test{}_{}.txt", i, j % 2),
+						[j](file_manager::WriteFileHandle& handle)
+						{
+							handle.write(std::string((j % 8) * 512, 'a'));
+						}
+					);
+				}
+			}
+		);
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	ASSERT_EQ(cache.getReservedCacheSize(), 0);
+	ASSERT_LE(cache.getCurrentCacheSize(), cache.getCacheSize());
+
+	cache.clear();
+
+	ASSERT_EQ(cache.getCurrentCacheSize(), 0);
+
+	cache.setCacheSize(0);
+}
+
+TEST(FileManager, Durability)
+{
+	using Durability = file_manager::WriteFileHandle::Durability;
+
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("durability_test.txt");
+	constexpr size_t groupCommitAppends = 64;
+	std::vector<std::future<void>> futures;
+
+	for (Durability durability : { Durability::none, Durability::dataSync, Durability::fullSync })
+	{
+		manager.writeFile
+		(
+			fileName,
+			[durability](file_manager::WriteTextFileHandle& handle)
+			{
+				handle.setDurability(durability);
+				handle.write("start\n");
+
+				ASSERT_EQ(handle.getDurability(), durability);
+			}
+		);
+	}
+
+	for (size_t i = 0; i < groupCommitAppends; i++)
+	{
+		futures.push_back
+		(
+			manager.appendFile
+			(
+				fileName,
+				[](file_manager::AppendFileHandle& handle)
+				{
+					handle.setDurability(Durability::groupCommit);
+					handle.write("record\n");
+				},
+				false
+			)
+		);
+	}
+
+	for (std::future<void>& future : futures)
+	{
+		future.get();
+	}
+
+	ASSERT_EQ(std::filesystem::file_size(fileName), 6 + groupCommitAppends * 7);
+}
+
+TEST(FileManager, ReplaceWrite)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	file_manager::Cache& cache = manager.getCache();
+	const std::string fileName("replace_write_test.txt");
+	const std::string previous = "previous data";
+	const std::string next = "replaced data";
+	std::latch readersStarted(2);
+	std::promise<void> isReplaced;
+	std::shared_future<void> replaced = isReplaced.get_future().share();
+	std::vector<std::thread> readers;
+
+	std::ofstream(fileName) << previous;
+
+	// Readers are executed on calling threads, so they don't depend on workers count
+	readers.emplace_back
+	(
+		[&]()
+		{
+			manager.readFile
+			(
+				fileName,
+				[&readersStarted, replaced, &previous](file_manager::ReadTextFileHandle& handle)
+				{
+					readersStarted.count_down();
+
+					ASSERT_EQ(replaced.wait_for(10s), std::future_status::ready);
+					ASSERT_EQ((std::ostringstream() << handle.getStream().rdbuf()).str(), previous);
+				}
+			);
+		}
+	);
+
+	readers.emplace_back
+	(
+		[&]()
+		{
+			manager.readPositionalFile
+			(
+				fileName,
+				[&readersStarted, replaced, &previous](file_manager::PositionalReadFileHandle& handle)
+				{
+					readersStarted.count_down();
+
+					ASSERT_EQ(replaced.wait_for(10s), std::future_status::ready);
+					ASSERT_EQ(handle.readData(0, 64), previous);
+				}
+			);
+		}
+	);
+
+	readersStarted.wait();
+
+	// Active readers are not waited for
+	manager.replaceFile
+	(
+		fileName,
+		[&next](file_manager::ReplaceTextFileHandle& handle)
+		{
+			handle.write(next);
+
+			ASSERT_TRUE(std::filesystem::exists(handle.getTemporaryPath()));
+		}
+	);
+
+	manager.readPositionalFile
+	(
+		fileName,
+		[&next](file_manager::PositionalReadFileHandle& handle)
+		{
+			ASSERT_EQ(handle.readData(0, 64), next);
+		}
+	);
+
+	isReplaced.set_value();
+
+	for (std::thread& reader : readers)
+	{
+		reader.join();
+	}
+
+	std::future<void> failed = manager.replaceFile
+	(
+		fileName,
+		[](file_manager::ReplaceTextFileHandle& handle)
+		{
+			handle.write("partial");
+
+			throw std::runtime_error("replace failed");
+		},
+		false
+	);
+
+	ASSERT_THROW(failed.get(), std::runtime_error);
+	ASSERT_EQ((std::ostringstream() << std::ifstream(fileName).rdbuf()).str(), next);
+
+	cache.setCacheSize(1_mib);
+
+	manager.readFile
+	(
+		fileName,
+		[&next](file_manager::ReadTextFileHandle& handle)
+		{
+			ASSERT_EQ(handle.readAllData(), next);
+		}
+	);
+
+	manager.replaceBinaryFile
+	(
+		fileName,
+		[](file_manager::ReplaceBinaryFileHandle& handle)
+		{
+			handle.write("cached data");
+		}
+	);
+
+	ASSERT_EQ(*cache.getCacheData(fileName), "cached data");
+	ASSERT_EQ((std::ostringstream() << std::ifstream(fileName).rdbuf()).str(), "cached data");
+
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(std::filesystem::current_path()))
+	{
+		ASSERT_FALSE(entry.path().filename().string().starts_with('.' + fileName));
+	}
+
+	cache.clear();
+	cache.setCacheSize(0);
+}
+
+TEST(FileManager, Preallocation)
+{
+	file_manager::FileManager& manager = file_manager::FileManager::getInstance();
+	const std::string fileName("preallocation_test.log");
+	const std::string record = "timestamp=1700000000 level=info message=request completed\n";
+	constexpr size_t appends = 100;
+
+	std::filesystem::remove(fileName);
+
+	manager.setPreallocation(fileName, 1_mib);
+
+	ASSERT_EQ(manager.getPreallocation(fileName), 1_mib);
+
+	for (size_t i = 0; i < appends; i++)
+	{
+		manager.appendFile
+		(
+			fileName,
+			[&record](file_manager::AppendFileHandle& handle)
+			{
+				handle.write(record);
+			}
+		);
+	}
+
+	// Preallocated space is not visible in file size
+	ASSERT_EQ(std::filesystem::file_size(fileName), appends * record.size());
+
+#ifdef __LINUX__
+	struct stat status;
+
+	ASSERT_EQ(stat(fileName.c_str(), &status), 0);
+	ASSERT_GE(static_cast<uint64_t>(status.st_blocks) * 512, 1_mib);
+#endif
+
+	// Last append before rotation
+	manager.appendFile
+	(
+		fileName,
+		[&record](file_manager::AppendFileHandle& handle)
+		{
+			handle.setPreallocation({ handle.getPreallocation().step, true });
+			handle.write({ record, record });
+		}
+	);
+
+	ASSERT_EQ(std::filesystem::file_size(fileName), (appends + 2) * record.size());
+
+#ifdef __LINUX__
+	ASSERT_EQ(stat(fileName.c_str(), &status), 0);
+	ASSERT_LT(static_cast<uint64_t>(status.st_blocks) * 512, 1_mib);
+#endif
+
+	manager.setPreallocation(fileName, 0);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+#include "Utility.h"
+
+namespace file_manager::_utility
+{
+	/**
+	 * @brief Pool of reusable buffers aligned for unbuffered I/O (O_DIRECT, FILE_FLAG_NO_BUFFERING)
+	 * Buffers are allocated on first use and kept for next handles up to maxFreeBuffers
+	 */
+	class FILE_MANAGER_API AlignedBufferPool
+	{
+	public:
+		/// @brief Alignment of buffer address, file offsets and transfer sizes. Covers logical block size of common devices
+		static constexpr size_t alignment = 4096;
+
+		/// @brief Size of each buffer
+		static constexpr size_t bufferSize = 4 * 1024 * 1024;
+
+		/// @brief Max count of idle buffers kept in pool
+		static constexpr size_t maxFreeBuffers = 8;
+
+	public:
+		/// @brief Buffer taken from pool. Returned to pool on destruction
+		class FILE_MANAGER_API Buffer
+		{
+		private:
+			std::byte* data;
+
+		public:
+			Buffer();
+
+			Buffer(const Buffer&) = delete;
+
+			Buffer(Buffer&& other) noexcept;
+
+			Buffer& operator = (const Buffer&) = delete;
+
+			Buffer& operator = (Buffer&& other) noexcept;
+
+			/// @brief Buffer memory, bufferSize bytes aligned to alignment
+			std::span<std::byte> get() const;
+
+			~Buffer();
+		};
+
+	private:
+		static std::byte* allocate();
+
+		static void deallocate(std::byte* data) noexcept;
+
+	public:
+		/// @brief Round size up to alignment
+		static constexpr size_t alignUp(size_t size);
+
+		/// @brief Round size down to alignment
+		static constexpr size_t alignDown(size_t size);
+
+		/// @brief Check that address is aligned
+		static bool isAligned(const void* data);
+
+		friend class Buffer;
+	};
+
+	constexpr size_t AlignedBufferPool::alignUp(size_t size)
+	{
+		return (size + alignment - 1) & ~(alignment - 1);
+	}
+
+	constexpr size_t AlignedBufferPool::alignDown(size_t size)
+	{
+		return size & ~(alignment - 1);
+	}
+}
@@ -2,11 +2,17 @@
 
 #include <unordered_map>
 #include <map>
+#include <list>
+#include <array>
 #include <mutex>
 #include <atomic>
 #include <vector>
+#include <memory>
+#include <functional>
+#include <type_traits>
+#include <initializer_list>
 
-#include "Utility.h"
+#include "FrequencySketch.h"
 
 namespace file_manager
 {
@@ -14,6 +20,7 @@ namespace file_manager
 
 	/**
 	 * @brief Files cache
+	 * Entries are evicted on insert when cache size is exceeded. Eviction bookkeeping is O(1) per access and uses sizes of cached data, so filesystem is never touched under lock
 	*/
 	class FILE_MANAGER_API Cache
 	{
@@ -26,15 +33,76 @@ namespace file_manager
 			notEnoughCacheSize
 		};
 
+		/// @brief How entries are chosen for eviction
+		enum class EvictionPolicy
+		{
+			lru, ///< Least recently used entry is evicted
+			windowTinyLfu ///< New entries pass small LRU window, then enter main space only if they are accessed more often than its eviction victim
+		};
+
+	private:
+		/// @brief Part of cache entry belongs to
+		enum class Segment
+		{
+			window, ///< Recently added entries. Whole cache for EvictionPolicy::lru
+			probation, ///< Main space entries not accessed since admission
+			frequent ///< Main space entries accessed after admission
+		};
+
+		struct Entry
+		{
+			std::filesystem::path filePath;
+			std::shared_ptr<std::string> data; ///< Shared with readers, so replaced or cleared data outlives requests that use it
+			size_t hash;
+			Segment segment;
+		};
+
 	private:
-		std::unordered_map<std::filesystem::path, std::string, utility::PathHash> cacheData;
+		/// @brief Percent of cache size given to window for EvictionPolicy::windowTinyLfu
+		static constexpr uint64_t windowPercent = 1;
+
+		/// @brief Percent of main space given to frequent segment
+		static constexpr uint64_t frequentPercent = 80;
+
+	private:
+		mutable std::array<std::list<Entry>, 3> segments; ///< Most recently used first
+		mutable std::array<uint64_t, 3> segmentSizes;
+		std::unordered_map<std::filesystem::path, std::list<Entry>::iterator, utility::PathHash> index;
+		mutable _utility::FrequencySketch sketch;
+		EvictionPolicy policy;
 		uint64_t cacheSize;
+		uint64_t invalidations; ///< Changed when cached data becomes outdated, so data read without lock is not cached over newer one
 		std::atomic<uint64_t> currentCacheSize;
+		std::atomic<uint64_t> reservedCacheSize;
 		mutable std::mutex cacheDataMutex;
 
 	private:
+		std::list<Entry>& getSegment(Segment segment) const;
+
+		uint64_t& getSegmentSize(Segment segment) const;
+
+		/// @brief Move entry to front of segment
+		void move(std::list<Entry>::iterator entry, Segment segment) const;
+
+		/// @brief Record access of cached entry and update its position
+		void touch(std::list<Entry>::iterator entry) const;
+
+		/// @brief Add new entry to window and evict. Size of data must be already added to currentCacheSize
+		/// @return Returns true if entry stays in cache
+		bool insert(const std::filesystem::path& filePath, std::shared_ptr<std::string>&& data);
+
+		void remove(std::list<Entry>::iterator entry);
+
+		/// @brief Move window candidate to main space if it is accessed more often than main space victims
+		void admit(std::list<Entry>::iterator candidate);
+
+		/// @brief Evict entries until cache size is not exceeded
 		void updateCache();
 
+		/// @brief Read file without lock and add it to cache
+		/// @param open Called only if file is not cached, returns stream at start of file or nullptr if file can't be opened
+		CacheResultCodes load(const std::filesystem::path& filePath, const std::function<std::istream*()>& open, std::shared_ptr<const std::string>& outData);
+
 		static Cache& getCache();
 
 	private:
@@ -48,6 +116,24 @@ namespace file_manager
 		/// @return Error code from Cache::CacheErrorCodes
 		CacheResultCodes addCache(const std::filesystem::path& filePath, std::ios_base::openmode mode);
 
+		/**
+		 * @brief Add cache data. File is read without lock
+		 * @param filePath Path to file
+		 * @param mode Open mode of file
+		 * @param outData File data. Set even if data was not admitted to cache, nullptr if file was not read
+		 * @return Error code from Cache::CacheErrorCodes
+		 */
+		CacheResultCodes addCache(const std::filesystem::path& filePath, std::ios_base::openmode mode, std::shared_ptr<const std::string>& outData);
+
+		/**
+		 * @brief Add cache data read from already opened stream, e.g. stream of read request, so file is not opened again
+		 * @param filePath Path to file
+		 * @param stream Stream at start of file. Not read if file is cached
+		 * @param outData File data. Set even if data was not admitted to cache, nullptr if file was not read
+		 * @return Error code from Cache::CacheErrorCodes
+		 */
+		CacheResultCodes addCache(const std::filesystem::path& filePath, std::istream& stream, std::shared_ptr<const std::string>& outData);
+
 		/**
 		 * @brief Append specific cache
 		 * @param filePath Path to file
@@ -76,14 +162,23 @@ namespace file_manager
 		/// @param filePath Path to file
 		void clear(const std::filesystem::path& filePath);
 
-		/// @brief Set cache size
+		/// @brief Set cache size. Entries are evicted if new size is exceeded
 		/// @param sizeInBytes Size in bytes
 		void setCacheSize(uint64_t sizeInBytes);
 
-		/// @brief Get cached data
+		/// @brief Set eviction policy. Defaults to EvictionPolicy::windowTinyLfu
+		/// @param policy Eviction policy
+		void setEvictionPolicy(EvictionPolicy policy);
+
+		/// @brief Get cached data. Data is shared, so it stays valid after entry is evicted, cleared or replaced
 		/// @return Cached data
 		/// @exception FileDoesNotExistException
-		const std::string& getCacheData(const std::filesystem::path& filePath) const;
+		std::shared_ptr<const std::string> getCacheData(const std::filesystem::path& filePath) const;
+
+		/// @brief Get cached data that stays valid after file cache is cleared or replaced
+		/// @param filePath Path to file
+		/// @return Cached data or nullptr if file is not cached
+		std::shared_ptr<const std::string> shareCacheData(const std::filesystem::path& filePath) const;
 
 		/// @brief Get global cache size
 		/// @return Cache size in bytes
@@ -93,12 +188,20 @@ namespace file_manager
 		/// @return Cache size in bytes
 		uint64_t getCurrentCacheSize() const;
 
+		/// @brief Part of used cache size reserved by writers for data that is cached on close
+		/// @return Cache size in bytes
+		uint64_t getReservedCacheSize() const;
+
+		/// @brief Get eviction policy
+		/// @return Eviction policy
+		EvictionPolicy getEvictionPolicy() const;
+
 		/**
-		 * @brief Get cached data
+		 * @brief Get cached data. Same as getCacheData
 		 * @return Cached data
 		 * @exception FileDoesNotExistException
 		*/
-		const std::string& operator [] (const std::filesystem::path& filePath) const;
+		std::shared_ptr<const std::string> operator [] (const std::filesystem::path& filePath) const;
 
 		friend void _utility::addCache(std::filesystem::path&& filePath, std::string&& data);
 
@@ -115,7 +218,24 @@ namespace file_manager
 		{
 			Cache& cache = Cache::getCache();
 
-			cache.currentCacheSize = OperationT<uint64_t>()(cache.currentCacheSize, amount);
+			// Writers reserve size without cache lock, so every change is a single atomic operation
+			for (std::atomic<uint64_t>* size : { &cache.currentCacheSize, &cache.reservedCacheSize })
+			{
+				if constexpr (std::is_same_v<OperationT<uint64_t>, std::plus<uint64_t>>)
+				{
+					size->fetch_add(amount);
+				}
+				else if constexpr (std::is_same_v<OperationT<uint64_t>, std::minus<uint64_t>>)
+				{
+					size->fetch_sub(amount);
+				}
+				else
+				{
+					uint64_t expected = size->load();
+
+					while (!size->compare_exchange_weak(expected, OperationT<uint64_t>()(expected, amount)));
+				}
+			}
 		}
 	}
 }
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <exception>
+
+#include "Utility.h"
+
+namespace file_manager
+{
+	/**
+	 * @brief Queue of finished requests. Requests submitted with FileManager::submitRequest post here instead of fulfilling std::future
+	 * Any thread may harvest completions in batches with poll or wait
+	 * On Linux queue can be multiplexed with sockets in epoll loop through getEventDescriptor
+	 */
+	class FILE_MANAGER_API CompletionQueue
+	{
+	public:
+		/// @brief Request result
+		enum class Status
+		{
+			success,
+			fileDoesNotExist,
+			notAFile,
+			failed ///< Callback or file operation threw exception
+		};
+
+		/// @brief Finished request
+		struct Completion
+		{
+			uint64_t userTag; ///< Tag passed to FileManager::submitRequest
+			Status status;
+			uint64_t bytes; ///< Bytes read or written through handle methods
+		};
+
+	private:
+		std::vector<Completion> completions;
+		size_t head;
+		size_t waiters;
+		mutable std::mutex completionsMutex;
+		std::condition_variable hasCompletions;
+#ifdef __LINUX__
+		int eventDescriptor;
+#endif
+
+	private:
+		void post(const Completion& completion);
+
+		size_t harvest(std::span<Completion> outCompletions);
+
+		static Status getStatus(const std::exception_ptr& exception);
+
+	public:
+		CompletionQueue();
+
+		CompletionQueue(const CompletionQueue&) = delete;
+
+		CompletionQueue& operator = (const CompletionQueue&) = delete;
+
+		/// @brief Harvest finished requests without blocking
+		/// @param outCompletions Completions are written from the beginning, at most outCompletions.size()
+		/// @return Number of harvested completions
+		size_t poll(std::span<Completion> outCompletions);
+
+		/// @brief Block until at least one request is finished and harvest finished requests
+		/// @param outCompletions Completions are written from the beginning, at most outCompletions.size()
+		/// @return Number of harvested completions
+		size_t wait(std::span<Completion> outCompletions);
+
+		/// @brief Block until at least one request is finished or timeout expires and harvest finished requests
+		/// @param outCompletions Completions are written from the beginning, at most outCompletions.size()
+		/// @param timeout Max waiting time
+		/// @return Number of harvested completions. 0 if timeout expired
+		template<typename Rep, typename Period>
+		size_t waitFor(std::span<Completion> outCompletions, const std::chrono::duration<Rep, Period>& timeout);
+
+		/// @brief Number of completions that are not harvested yet
+		size_t size() const;
+
+#ifdef __LINUX__
+		/**
+		 * @brief Nonblocking eventfd that is readable while queue has completions. Created on first call, owned by queue
+		 * Harvesting all completions makes it unreadable again, so it can be used with level triggered epoll without reading it
+		 * @return eventfd descriptor
+		 * @exception std::system_error eventfd creation failed
+		 */
+		int getEventDescriptor();
+#endif
+
+		~CompletionQueue();
+
+		friend class FileManager;
+	};
+
+	template<typename Rep, typename Period>
+	size_t CompletionQueue::waitFor(std::span<Completion> outCompletions, const std::chrono::duration<Rep, Period>& timeout)
+	{
+		std::unique_lock<std::mutex> lock(completionsMutex);
+
+		waiters++;
+
+		hasCompletions.wait_for(lock, timeout, [this]() { return head != completions.size(); });
+
+		waiters--;
+
+		return this->harvest(outCompletions);
+	}
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#ifdef __LINUX__
+#include <cstdio>
+#include <memory>
+#include <streambuf>
+#include <string_view>
+#include <span>
+
+#include "DescriptorCache.h"
+
+namespace file_manager::_utility
+{
+	/**
+	 * @brief Stream buffer over native descriptor, used by stream handles instead of std::filebuf on Linux. Linux only
+	 * std::filebuf can't take descriptor it didn't open or expose its own, so descriptors of node files are taken from DescriptorCache and given back on close
+	 * Input reads with pread from tracked offset. Output collects data in put area and writes it with pwritev, big writes go to file together with put area in one call
+	 * Open and close follow std::filebuf, so buffer can replace it in derived classes
+	 */
+	class FILE_MANAGER_API DescriptorBuffer : public std::streambuf
+	{
+	private:
+		static constexpr size_t inputBufferSize = 64 * 1024;
+
+		/// @brief Same as std::filebuf
+		static constexpr size_t outputBufferSize = BUFSIZ;
+
+	private:
+		int descriptor;
+		FileNode* node; ///< Owner of cached descriptor, nullptr if descriptor is closed on close
+		DescriptorCache::Access access;
+		std::ios_base::openmode mode;
+		std::unique_ptr<char[]> ownedBuffer;
+		char* bufferData;
+		size_t bufferSize;
+		uint64_t bufferOffset; ///< File offset of get or put area start. Not used by append output
+
+	private:
+		uint64_t getPosition() const;
+
+		/// @brief Set up get or put area after descriptor is opened
+		void initialize(std::ios_base::openmode mode);
+
+		/// @brief Write put area and data that follows it in one pwritev, or several if there are more than IOV_MAX parts
+		/// @return False if write fails
+		bool writeBuffer(std::span<const std::string_view> data);
+
+		/// @brief Write put area and data that follows it
+		/// @return False if write fails
+		bool writeBuffer(std::string_view data = std::string_view());
+
+		pos_type seek(off_type offset, int whence, std::ios_base::openmode which);
+
+	protected:
+		/// @brief Use data as put area of next opened output. Ignored after open and for input
+		std::streambuf* setbuf(char* data, std::streamsize size) override;
+
+		int_type underflow() override;
+
+		std::streamsize xsgetn(char* data, std::streamsize count) override;
+
+		std::streamsize showmanyc() override;
+
+		int_type overflow(int_type character) override;
+
+		std::streamsize xsputn(const char* data, std::streamsize count) override;
+
+		int sync() override;
+
+		pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override;
+
+		pos_type seekpos(pos_type position, std::ios_base::openmode which) override;
+
+	public:
+		DescriptorBuffer();
+
+		DescriptorBuffer(const DescriptorBuffer&) = delete;
+
+		DescriptorBuffer& operator = (const DescriptorBuffer&) = delete;
+
+		/**
+		 * @brief Take descriptor of node file from DescriptorCache
+		 * @param node File node
+		 * @param mode std::ios_base::in reads, std::ios_base::app appends, other output truncates file
+		 * @return this or nullptr if file can't be opened
+		 */
+		DescriptorBuffer* open(FileNode* node, std::ios_base::openmode mode);
+
+		/**
+		 * @brief Open file that is not cached, e.g. temporary file of replace
+		 * @param filePath Path to file
+		 * @param mode Same as for open with node
+		 * @return this or nullptr if file can't be opened
+		 */
+		DescriptorBuffer* open(const std::filesystem::path& filePath, std::ios_base::openmode mode);
+
+		/**
+		 * @brief Write pending data and give descriptor back to DescriptorCache or close it. Pending data is written through overflow
+		 * @param isCached If false descriptor is closed instead of given back, e.g. when file is removed
+		 * @return this or nullptr if buffer isn't open or pending data can't be written
+		 */
+		DescriptorBuffer* close(bool isCached = true);
+
+		/**
+		 * @brief Write several buffers in order. Buffers that fit into put area are copied there
+		 * Otherwise put area and all buffers go to file in one pwritev without copying
+		 * @param buffers Data buffers
+		 * @return False if buffer isn't open for output or write fails
+		 */
+		bool writeVectored(std::span<const std::string_view> buffers);
+
+		bool is_open() const;
+
+		/// @brief Native descriptor, -1 if buffer isn't open
+		int getDescriptor() const;
+
+		~DescriptorBuffer();
+	};
+}
+#endif
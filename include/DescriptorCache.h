@@ -0,0 +1,99 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+#include <mutex>
+
+#include "FileNode.h"
+
+namespace file_manager
+{
+	/**
+	 * @brief Bounded LRU cache of idle native descriptors keyed by FileNode
+	 * Descriptors returned by requests stay open, so next request to the same file skips open
+	 * Descriptors are dropped when FileManager replaces or removes file. Cached descriptor is also checked with one fstat before reuse and reopened if its file lost all links, e.g. was replaced by rename or removed outside FileManager
+	 */
+	class FILE_MANAGER_API DescriptorCache
+	{
+	public:
+		/// @brief How descriptor is opened
+		enum class Access
+		{
+			read, ///< Read only
+			write, ///< Write only. File is created if it does not exist, writer truncates it
+			append ///< Write only, every write goes to the end of file. File is created if it does not exist
+		};
+
+	private:
+		struct Entry
+		{
+			FileNode* node;
+			Access access;
+			FileNode::NativeHandle descriptor;
+		};
+
+		struct KeyHash
+		{
+			size_t operator () (const std::pair<FileNode*, Access>& key) const noexcept;
+		};
+
+	private:
+		std::list<Entry> entries; ///< Most recently used first
+		std::unordered_map<std::pair<FileNode*, Access>, std::list<Entry>::iterator, KeyHash> index;
+		size_t limit;
+		mutable std::mutex entriesMutex;
+
+	private:
+		/// @brief Open new descriptor
+		/// @exception std::system_error
+		static FileNode::NativeHandle open(const std::filesystem::path& filePath, Access access);
+
+		static void close(FileNode::NativeHandle descriptor);
+
+		/// @brief Check that file of descriptor is still linked. Path is not resolved, so check costs one fstat
+		static bool isValid(FileNode::NativeHandle descriptor);
+
+		/// @brief Soft RLIMIT_NOFILE. Descriptors limit is not enforced on Windows, so fixed value is used there
+		static size_t getProcessLimit();
+
+	public:
+		/// @brief Limit defaults to quarter of process descriptors limit
+		DescriptorCache();
+
+		DescriptorCache(const DescriptorCache&) = delete;
+
+		DescriptorCache& operator = (const DescriptorCache&) = delete;
+
+		/// @brief Take cached descriptor or open new one. Caller owns it until release
+		/// @param node File node
+		/// @param access Descriptor access
+		/// @return Native descriptor
+		/// @exception std::system_error if file can't be opened
+		FileNode::NativeHandle acquire(FileNode* node, Access access);
+
+		/// @brief Return descriptor to cache. Least recently used descriptors are closed when limit is exceeded
+		/// @param node File node
+		/// @param access Descriptor access
+		/// @param descriptor Descriptor taken with acquire
+		void release(FileNode* node, Access access, FileNode::NativeHandle descriptor);
+
+		/// @brief Close cached descriptors of file
+		/// @param node File node
+		void invalidate(FileNode* node);
+
+		/// @brief Close all cached descriptors
+		void clear();
+
+		/// @brief Set max count of cached descriptors. Clamped to half of process descriptors limit, 0 disables caching
+		/// @param limit Descriptors count
+		void setLimit(size_t limit);
+
+		/// @brief Max count of cached descriptors
+		size_t getLimit() const;
+
+		/// @brief Count of cached descriptors
+		size_t size() const;
+
+		~DescriptorCache();
+	};
+}
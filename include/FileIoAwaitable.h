@@ -0,0 +1,150 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+
+#include "IoRing.h"
+
+namespace file_manager
+{
+	class FileManager;
+	class FileNode;
+
+	namespace _utility
+	{
+		/**
+		 * @brief Whole file read, write or append queued through FileNode
+		 * With FileManager::IoBackend::ioUring admitted request only opens file and submits I/O to io_uring, worker is released at once
+		 * File stays locked for this request until I/O completes, so per file reader/writer ordering is the same as for other requests
+		 */
+		class FILE_MANAGER_API FileIoOperation
+#ifdef __LINUX__
+			: private IoRing::Operation
+#endif
+		{
+		public:
+			enum class Kind
+			{
+				read,
+				write,
+				append
+			};
+
+		private:
+			/// @brief Max bytes of single io_uring operation
+			static constexpr size_t maxChunkSize = 1ULL << 30;
+
+		private:
+			FileManager& manager;
+			std::filesystem::path filePath;
+			FileNode* node;
+			std::coroutine_handle<> coroutine;
+			std::exception_ptr exception;
+			Kind kind;
+#ifdef __LINUX__
+			IoRing* ring;
+			int descriptor;
+#endif
+
+		protected:
+			std::string data;
+			uint64_t transferredBytes;
+
+		private:
+			/// @brief Executed on worker when request is admitted
+			void start(FileNode* node);
+
+			/// @brief Perform operation with std::fstream based handle on current worker
+			void execute();
+
+#ifdef __LINUX__
+			/// @brief Open file and submit first chunk
+			void submit();
+
+			void submitNextChunk();
+
+			void complete(int32_t result) override;
+#endif
+
+			/// @brief Close file, release request and resume coroutine. On completion thread coroutine is resumed on worker
+			void finish(bool isOnWorker);
+
+		protected:
+			FileIoOperation(FileManager& manager, const std::filesystem::path& filePath, Kind kind, std::string&& data);
+
+			/// @brief Queue request. Coroutine is resumed on FileManager worker after operation completes
+			void suspend(std::coroutine_handle<> coroutine);
+
+			/// @brief Rethrow exception of failed operation
+			void checkResult() const;
+
+		public:
+			FileIoOperation(const FileIoOperation&) = delete;
+
+			FileIoOperation& operator = (const FileIoOperation&) = delete;
+
+			~FileIoOperation() = default;
+		};
+	}
+
+	/**
+	 * @brief Awaitable returned by FileManager::asyncRead, asyncWrite and asyncAppend
+	 * co_await returns file's data for reads and number of written bytes for writes
+	 */
+	template<_utility::FileIoOperation::Kind KindV>
+	class FileIoAwaitable : private _utility::FileIoOperation
+	{
+	public:
+		using ResultT = std::conditional_t<KindV == Kind::read, std::string, uint64_t>;
+
+	public:
+		FileIoAwaitable(FileManager& manager, const std::filesystem::path& filePath, std::string&& data = std::string());
+
+		bool await_ready() const noexcept;
+
+		void await_suspend(std::coroutine_handle<> coroutine);
+
+		ResultT await_resume();
+	};
+
+	using FileReadAwaitable = FileIoAwaitable<_utility::FileIoOperation::Kind::read>;
+	using FileWriteAwaitable = FileIoAwaitable<_utility::FileIoOperation::Kind::write>;
+	using FileAppendAwaitable = FileIoAwaitable<_utility::FileIoOperation::Kind::append>;
+
+	template<_utility::FileIoOperation::Kind KindV>
+	FileIoAwaitable<KindV>::FileIoAwaitable(FileManager& manager, const std::filesystem::path& filePath, std::string&& data) :
+		FileIoOperation(manager, filePath, KindV, std::move(data))
+	{
+
+	}
+
+	template<_utility::FileIoOperation::Kind KindV>
+	bool FileIoAwaitable<KindV>::await_ready() const noexcept
+	{
+		return false;
+	}
+
+	template<_utility::FileIoOperation::Kind KindV>
+	void FileIoAwaitable<KindV>::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		this->suspend(coroutine);
+	}
+
+	template<_utility::FileIoOperation::Kind KindV>
+	typename FileIoAwaitable<KindV>::ResultT FileIoAwaitable<KindV>::await_resume()
+	{
+		this->checkResult();
+
+		if constexpr (KindV == Kind::read)
+		{
+			return std::move(data);
+		}
+		else
+		{
+			return transferredBytes;
+		}
+	}
+}
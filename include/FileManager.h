@@ -5,123 +5,229 @@
 #include <map>
 #include <thread>
 #include <mutex>
+#include <shared_mutex>
+#include <array>
 #include <fstream>
 #include <functional>
 #include <variant>
 #include <queue>
 #include <sstream>
 #include <future>
+#include <coroutine>
+#include <optional>
+#include <exception>
+#include <span>
 
 #include "Cache.h"
+#include "DescriptorCache.h"
+#include "FileNode.h"
+#include "CompletionQueue.h"
+#include "FileIoAwaitable.h"
 
 #include "Handlers/FileHandle.h"
-#include "Handlers/ReadFileHandle.h"
-#include "Handlers/WriteFileHandle.h"
+#include "Handlers/BasicReadFileHandle.h"
+#include "Handlers/BasicWriteFileHandle.h"
+#include "Handlers/BasicReplaceFileHandle.h"
+#include "Handlers/MappedFileHandle.h"
+#include "Handlers/PositionalReadFileHandle.h"
+#include "Handlers/DirectReadFileHandle.h"
+#include "Handlers/DirectWriteFileHandle.h"
 
 namespace file_manager
 {
-	/// @brief Provides files accessing from multiple threads. Singleton
-	class FILE_MANAGER_API FileManager
+	namespace _utility
+	{
+		/// @brief ReadFileHandle or WriteFileHandle depending on handle type. Handles that do not derive from them are their own base
+		template<typename HandleT>
+		using BaseFileHandle = std::conditional_t
+		<
+			std::derived_from<HandleT, ReadFileHandle>,
+			ReadFileHandle,
+			std::conditional_t<std::derived_from<HandleT, WriteFileHandle>, WriteFileHandle, HandleT>
+		>;
+
+		/// @brief FileNode request type for handle type. Only write handles need exclusive access, replace handles exclude writers only
+		template<typename HandleT>
+		inline constexpr FileNode::RequestType requestType = std::derived_from<HandleT, ReplaceFileHandle> ?
+			FileNode::RequestType::replace :
+			std::derived_from<HandleT, WriteFileHandle> || std::derived_from<HandleT, DirectWriteFileHandle> ? FileNode::RequestType::write : FileNode::RequestType::read;
+
+		/// @brief Callback takes handle by reference or std::unique_ptr to its base. Only the latter allocates handle on heap
+		template<typename T, typename HandleT>
+		concept FileCallback = std::invocable<T&, HandleT&> || std::invocable<T&, std::unique_ptr<BaseFileHandle<HandleT>>&&>;
+	}
+
+	class FileManager;
+
+	/// @brief Request of FileManager::submitBatch
+	class FILE_MANAGER_API BatchRequest
 	{
 	private:
-		enum class RequestType
-		{
-			read,
-			write
-		};
+		/// @brief Builds handle, calls user callback and releases handle. Small enough to be stored inline with batch completion state in FileNode::RequestCallback
+		using Executor = _utility::MoveOnlyFunction<void(FileNode*), 64>;
 
-		enum class RequestFileHandleType
-		{
-			read,
-			write,
-			readBinary,
-			writeBinary,
-			append,
-			appendBinary
-		};
+	private:
+		std::filesystem::path filePath;
+		Executor executor;
+		FileNode::RequestType type;
 
 	private:
-		using FileCallback = std::variant<std::function<void(std::unique_ptr<ReadFileHandle>&&)>, std::function<void(std::unique_ptr<WriteFileHandle>&&)>>;
+		BatchRequest(const std::filesystem::path& filePath, Executor&& executor, FileNode::RequestType type);
 
-		struct RequestStruct
-		{
-			FileCallback callback;
-			std::promise<void> requestPromise;
-			RequestFileHandleType handleType;
+	public:
+		/// @brief Create batch request
+		/// @tparam HandleT BasicReadFileHandle or BasicWriteFileHandle specialization, e.g. ReadBinaryFileHandle or AppendFileHandle
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for reading or writing file
+		template<typename HandleT, _utility::FileCallback<HandleT> CallbackT>
+		static BatchRequest create(const std::filesystem::path& filePath, CallbackT&& callback);
 
-			RequestStruct(FileCallback&& callback, std::promise<void>&& requestPromise, RequestFileHandleType handleType);
-		};
+		BatchRequest(BatchRequest&&) noexcept = default;
 
-		friend bool operator == (const RequestStruct& request, RequestType type);
+		BatchRequest& operator = (BatchRequest&&) noexcept = default;
 
-	private:
-		class FileNode
-		{
-		private:
-			struct FilePathState
-			{
-				std::atomic_size_t readRequests;
-				std::atomic_bool isWriteRequest;
+		~BatchRequest() = default;
 
-				FilePathState();
-			};
+		friend class FileManager;
+	};
 
-		private:
-			std::queue<RequestStruct> requests;
-			std::mutex requestsMutex;
+	/**
+	 * @brief Awaitable file request. Request is queued when coroutine suspends
+	 * Coroutine is resumed on FileManager worker after operation is done and handle is released
+	 * @tparam HandleT BasicReadFileHandle or BasicWriteFileHandle specialization
+	 * @tparam OperationT Callable that takes HandleT&. Its result is the result of co_await
+	 */
+	template<typename HandleT, typename OperationT>
+	class FileRequestAwaitable
+	{
+	public:
+		using ResultT = std::invoke_result_t<OperationT&, HandleT&>;
 
-		public:
-			FilePathState state;
+	private:
+		FileManager& manager;
+		std::filesystem::path filePath;
+		OperationT operation;
+		std::optional<std::conditional_t<std::is_void_v<ResultT>, std::monostate, ResultT>> result;
+		std::exception_ptr exception;
 
-		public:
-			FileNode() = default;
+	public:
+		FileRequestAwaitable(FileManager& manager, const std::filesystem::path& filePath, OperationT&& operation);
+
+		bool await_ready() const noexcept;
 
-			void addRequest(FileCallback&& callback, std::promise<void>&& requestPromise, RequestFileHandleType handleType);
+		void await_suspend(std::coroutine_handle<> coroutine);
+
+		ResultT await_resume();
+	};
 
-			void processQueue(const std::filesystem::path& filePath);
+	/// @brief Provides files accessing from multiple threads. Singleton
+	class FILE_MANAGER_API FileManager
+	{
+	public:
+		/// @brief How requests that become admissible after handle release are dispatched
+		enum class DispatchMode
+		{
+			deferred, ///< Post separate thread pool task that processes file queue
+			direct, ///< Releasing thread processes file queue and posts admitted requests to thread pool
+			inlineHandoff ///< Same as direct, but releasing worker executes first admitted request itself after its own request completes
+		};
 
-			~FileNode() = default;
+		/// @brief How asyncRead, asyncWrite and asyncAppend perform I/O
+		enum class IoBackend
+		{
+			threadPool, ///< Blocking std::fstream I/O on worker
+			ioUring ///< Worker only opens file and submits I/O to io_uring. Linux only
 		};
 
+	private:
+		using RequestType = FileNode::RequestType;
+
+	private:
+		/// @brief Path to FileNode index split into independently locked shards
 		class FILE_MANAGER_API NodesContainer
 		{
 		private:
-			std::unordered_map<std::filesystem::path, FileNode*, utility::PathHash> data;
-			mutable std::mutex readWriteMutex;
+			static constexpr size_t shardsBits = 6;
+			static constexpr size_t shardsCount = 1ULL << shardsBits;
+
+		private:
+			struct alignas(64) Shard
+			{
+				std::unordered_map<std::filesystem::path, FileNode*, utility::PathHash> data;
+				mutable std::shared_mutex readWriteMutex;
+			};
+
+		private:
+			std::array<Shard, shardsCount> shards;
+
+		private:
+			Shard& getShard(const std::filesystem::path& filePath);
 
 		public:
 			NodesContainer() = default;
 
-			void addNode(const std::filesystem::path& filePath);
-			
-			FileNode* operator [](const std::filesystem::path& filePath) const;
+			FileNode* addNode(const std::filesystem::path& filePath);
+
+			/// @brief Resolve many nodes locking every involved shard once
+			/// @param filePaths Paths to files
+			/// @param outNodes Nodes in the same order as filePaths
+			void addNodes(std::span<const std::filesystem::path* const> filePaths, std::span<FileNode*> outNodes);
 
 			inline ~NodesContainer()
 			{
-				for (const auto& [_, value] : data)
+				for (Shard& shard : shards)
 				{
-					delete value;
-				}
+					for (const auto& [_, value] : shard.data)
+					{
+						delete value;
+					}
 
-				data.clear();
+					shard.data.clear();
+				}
 			}
 		};
 
+		/// @brief Aggregate completion of submitBatch. Deleted by last finished request
+		struct BatchCompletion
+		{
+			std::promise<void> batchPromise;
+			std::exception_ptr exception;
+			std::atomic_size_t remainingRequests;
+			std::atomic_flag hasException;
+
+			BatchCompletion(size_t requests);
+
+			/// @brief Complete one request. First exception is passed to future
+			void complete(std::exception_ptr requestException);
+		};
+
 	private:
 		Cache cache;
 		NodesContainer nodes;
+		DescriptorCache descriptorCache;
 		std::shared_ptr<threading::ThreadPool> threadPool;
+		std::atomic<DispatchMode> dispatchMode;
+		std::atomic<IoBackend> ioBackend;
+		std::atomic_size_t writeBufferSize;
+#ifdef __LINUX__
+		std::unique_ptr<_utility::IoRing> ioRing;
+		std::mutex ioRingMutex;
+#endif
 
 	private:
-		FileHandle* createHandle(const std::filesystem::path& filePath, RequestFileHandleType handleType);
+		FileNode* getNode(const std::filesystem::path& filePath, bool isFileAlreadyExist);
 
-		void notify(std::filesystem::path&& filePath);
+		/// @brief Check that file exists and is regular file with single stat
+		/// @exception FileDoesNotExistException
+		/// @exception NotAFileException
+		static void checkFile(const std::filesystem::path& filePath);
 
-		void addRequest(const std::filesystem::path& filePath, FileCallback&& callback, std::promise<void>&& requestPromise, RequestFileHandleType handleType);
+		void notify(FileNode* node);
 
-		void decreaseReadRequests(const std::filesystem::path& filePath);
-
-		void completeWriteRequest(const std::filesystem::path& filePath);
+#ifdef __LINUX__
+		/// @brief io_uring instance if current backend is IoBackend::ioUring, otherwise nullptr
+		_utility::IoRing* getIoRing() const;
+#endif
 
 	private:
 		FileManager();
@@ -141,9 +247,21 @@ namespace file_manager
 		~FileManager() = default;
 
 	private:
-		std::future<void> addReadRequest(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<ReadFileHandle>&&)>& callback, RequestFileHandleType handleType, bool wait);
+		/**
+		 * @brief Resolve file node and queue request. Callback, request and completion state are allocated in RequestArena
+		 * @tparam HandleT BasicReadFileHandle or BasicWriteFileHandle specialization
+		 */
+		template<typename HandleT, typename CallbackT>
+		std::future<void> addRequest(const std::filesystem::path& filePath, CallbackT&& callback, bool wait);
 
-		std::future<void> addWriteRequest(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<WriteFileHandle>&&)>& callback, RequestFileHandleType handleType, bool wait);
+		/**
+		 * @brief Construct handle, call callback and release handle
+		 * @tparam HandleT BasicReadFileHandle or BasicWriteFileHandle specialization
+		 * @param isQueued If true handle is released inside FileNode::HandoffScope
+		 * @return Bytes transferred through handle
+		 */
+		template<typename HandleT, typename CallbackT>
+		static uint64_t execute(FileNode* node, CallbackT& callback, bool isQueued);
 
 	public:
 		/**
@@ -184,47 +302,192 @@ namespace file_manager
 		/// @brief Read file in standard mode
 		/// @param filePath Path to file
 		/// @param callback Function that will be called for reading file
-		/// @param wait If true thread will wait till callback end
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
 		/// @exception FileDoesNotExistException 
 		/// @exception NotAFileException 
 		std::future<void> readFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<ReadFileHandle>&&)>& callback, bool wait = true);
 
+		/// @brief Read file in standard mode. Callback is moved into request without heap allocation. Callback that takes ReadTextFileHandle& gets handle constructed in place
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for reading file
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		/// @exception FileDoesNotExistException 
+		/// @exception NotAFileException 
+		template<_utility::FileCallback<ReadTextFileHandle> CallbackT>
+		std::future<void> readFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
 		/// @brief Read file in binary mode
 		/// @param filePath Path to file
 		/// @param callback Function that will be called for reading file
-		/// @param wait If true thread will wait till callback end
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
 		/// @exception FileDoesNotExistException 
 		/// @exception NotAFileException 
 		std::future<void> readBinaryFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<ReadFileHandle>&&)>& callback, bool wait = true);
 
+		/// @brief Read file in binary mode. Callback is moved into request without heap allocation. Callback that takes ReadBinaryFileHandle& gets handle constructed in place
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for reading file
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		/// @exception FileDoesNotExistException 
+		/// @exception NotAFileException 
+		template<_utility::FileCallback<ReadBinaryFileHandle> CallbackT>
+		std::future<void> readBinaryFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
+		/// @brief Read memory mapped file without copying it
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for reading file. Mapping is valid until callback returns
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		/// @exception FileDoesNotExistException 
+		/// @exception NotAFileException 
+		template<_utility::FileCallback<MappedFileHandle> CallbackT>
+		std::future<void> readMappedFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
+		/// @brief Read file at explicit offsets. Concurrent readers share one descriptor instead of opening file each
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for reading file
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		/// @exception FileDoesNotExistException 
+		/// @exception NotAFileException 
+		template<_utility::FileCallback<PositionalReadFileHandle> CallbackT>
+		std::future<void> readPositionalFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
+		/// @brief Read big binary file bypassing page cache
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for reading file
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		/// @exception FileDoesNotExistException 
+		/// @exception NotAFileException 
+		template<_utility::FileCallback<DirectReadFileHandle> CallbackT>
+		std::future<void> readDirectFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
 		/// @brief Create/Recreate and write file in standard mode
 		/// @param filePath Path to file
 		/// @param callback Function that will be called for writing file
-		/// @param wait If true thread will wait till callback end
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
 		std::future<void> writeFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<WriteFileHandle>&&)>& callback, bool wait = true);
 
+		/// @brief Create/Recreate and write file in standard mode. Callback is moved into request without heap allocation. Callback that takes WriteTextFileHandle& gets handle constructed in place
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for writing file
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		template<_utility::FileCallback<WriteTextFileHandle> CallbackT>
+		std::future<void> writeFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
 		/// @brief Create file if it does not exist and write file in standard mode
 		/// @param filePath Path to file
 		/// @param callback Function that will be called for writing file
-		/// @param wait If true thread will wait till callback end
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
 		std::future<void> appendFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<WriteFileHandle>&&)>& callback, bool wait = true);
 
+		/// @brief Create file if it does not exist and write file in standard mode. Callback is moved into request without heap allocation. Callback that takes AppendFileHandle& gets handle constructed in place
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for writing file
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		template<_utility::FileCallback<AppendFileHandle> CallbackT>
+		std::future<void> appendFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
 		/// @brief Create/Recreate and write file in binary mode
 		/// @param filePath Path to file
 		/// @param callback Function that will be called for writing file
-		/// @param wait If true thread will wait till callback end
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
 		std::future<void> writeBinaryFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<WriteFileHandle>&&)>& callback, bool wait = true);
 
+		/// @brief Create/Recreate and write file in binary mode. Callback is moved into request without heap allocation. Callback that takes WriteBinaryFileHandle& gets handle constructed in place
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for writing file
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		template<_utility::FileCallback<WriteBinaryFileHandle> CallbackT>
+		std::future<void> writeBinaryFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
+		/// @brief Create/Recreate and write big binary file bypassing page cache
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for writing file
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		template<_utility::FileCallback<DirectWriteFileHandle> CallbackT>
+		std::future<void> writeDirectFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
+		/**
+		 * @brief Create/Recreate file atomically in standard mode. Data is written to temporary file that is synced and renamed over file when callback ends
+		 * Readers of file are not waited for: active ones keep reading previous data, none of them sees partially written file
+		 * File is left unchanged if callback throws. Other writers of file wait for replace as usual
+		 * @param filePath Path to file
+		 * @param callback Function that will be called for writing file
+		 * @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		 */
+		template<_utility::FileCallback<ReplaceTextFileHandle> CallbackT>
+		std::future<void> replaceFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
+		/// @brief Create/Recreate file atomically in binary mode. Same as replaceFile
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for writing file
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		template<_utility::FileCallback<ReplaceBinaryFileHandle> CallbackT>
+		std::future<void> replaceBinaryFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
 		/// @brief Create file if it does not exist and write file in binary mode
 		/// @param filePath Path to file
 		/// @param callback Function that will be called for writing file
-		/// @param wait If true thread will wait till callback end
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
 		std::future<void> appendBinaryFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<WriteFileHandle>&&)>& callback, bool wait = true);
 
+		/// @brief Create file if it does not exist and write file in binary mode. Callback is moved into request without heap allocation. Callback that takes AppendBinaryFileHandle& gets handle constructed in place
+		/// @param filePath Path to file
+		/// @param callback Function that will be called for writing file
+		/// @param wait If true thread will wait till callback end. If file is not used by other requests callback is called in current thread and returned future is already ready
+		template<_utility::FileCallback<AppendBinaryFileHandle> CallbackT>
+		std::future<void> appendBinaryFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait = true);
+
+		/**
+		 * @brief Awaitable request. Does not block calling thread, coroutine resumes on FileManager worker after operation
+		 * @tparam HandleT BasicReadFileHandle or BasicWriteFileHandle specialization, e.g. ReadBinaryFileHandle or AppendFileHandle
+		 * @param filePath Path to file
+		 * @param operation Function that will be called with handle on FileManager worker. Its result is returned from co_await
+		 * @exception FileDoesNotExistException Thrown from co_await for read requests
+		 * @exception NotAFileException Thrown from co_await for read requests
+		 */
+		template<typename HandleT, std::invocable<HandleT&> OperationT>
+		FileRequestAwaitable<HandleT, std::decay_t<OperationT>> asyncRequest(const std::filesystem::path& filePath, OperationT&& operation);
+
+		/**
+		 * @brief Queue request that posts its result to completion queue instead of fulfilling std::future. Never blocks and never calls callback in current thread
+		 * @tparam HandleT BasicReadFileHandle or BasicWriteFileHandle specialization, e.g. ReadBinaryFileHandle or AppendFileHandle
+		 * @param filePath Path to file
+		 * @param callback Function that will be called for reading or writing file
+		 * @param completionQueue Queue that receives completion. Must outlive request
+		 * @param userTag Value that identifies request in completion
+		 */
+		template<typename HandleT, _utility::FileCallback<HandleT> CallbackT>
+		void submitRequest(const std::filesystem::path& filePath, CallbackT&& callback, CompletionQueue& completionQueue, uint64_t userTag);
+
+		/**
+		 * @brief Queue many requests across many files at once. Nodes are resolved with one lock per shard and admitted requests are posted to thread pool as one task per worker
+		 * Callbacks must not wait for other requests, admitted requests of one worker are executed one after another
+		 * @param requests Requests. Moved from
+		 * @return Future that is ready when all requests are finished. Holds first exception thrown by callbacks or by file checks
+		 */
+		std::future<void> submitBatch(std::span<BatchRequest> requests);
+
+		/// @brief Awaitable read of all file data in standard mode. Uses current IoBackend
+		/// @param filePath Path to file
+		/// @return Awaitable that returns file's data
+		FileReadAwaitable asyncRead(const std::filesystem::path& filePath);
+
+		/// @brief Awaitable create/recreate and write file in standard mode. Uses current IoBackend
+		/// @param filePath Path to file
+		/// @param data Data to write
+		/// @return Awaitable that returns number of written bytes
+		FileWriteAwaitable asyncWrite(const std::filesystem::path& filePath, std::string data);
+
+		/// @brief Awaitable append to file in standard mode. File is created if it does not exist. Uses current IoBackend
+		/// @param filePath Path to file
+		/// @param data Data to append
+		/// @return Awaitable that returns number of written bytes
+		FileAppendAwaitable asyncAppend(const std::filesystem::path& filePath, std::string data);
+
 		/**
 		 * @brief Remove file from filesystem and from cache
 		 * @param filePath Path to file
-		 * @param wait If true thread will wait file removing
+		 * @param wait If true thread will wait file removing. If file is not used by other requests it is removed in current thread and returned future is already ready
 		 * @return 
 		 */
 		std::future<void> removeFile(const std::filesystem::path& filePath, bool wait = true);
@@ -236,6 +499,44 @@ namespace file_manager
 		 */
 		bool exists(const std::filesystem::path& filePath) const;
 
+		/// @brief Set how requests are dispatched after handle release. Default is DispatchMode::inlineHandoff
+		/// @param mode Dispatch mode
+		void setDispatchMode(DispatchMode mode);
+
+		/// @brief Dispatch mode getter
+		/// @return Current dispatch mode
+		DispatchMode getDispatchMode() const;
+
+		/// @brief Set I/O backend of asyncRead, asyncWrite and asyncAppend. Default is IoBackend::threadPool
+		/// @param backend I/O backend. io_uring instance is created on first switch to IoBackend::ioUring and kept until FileManager destruction
+		/// @exception std::system_error io_uring is not available
+		void setIoBackend(IoBackend backend);
+
+		/// @brief I/O backend getter
+		/// @return Current I/O backend
+		IoBackend getIoBackend() const;
+
+		/// @brief Set stream buffer size of write handles created after this call
+		/// @param size Buffer size in bytes. 0 for std::filebuf default
+		void setWriteBufferSize(size_t size);
+
+		/// @brief Write handles stream buffer size getter
+		/// @return Buffer size in bytes. 0 for std::filebuf default
+		size_t getWriteBufferSize() const;
+
+		/**
+		 * @brief Set preallocation step of append requests to file. Appends grow file with fallocate in such steps keeping file size, so frequent small appends don't fragment it
+		 * Space past end of file is freed by request with WriteFileHandle::Preallocation::isTrimmedOnClose and when FileManager is destroyed. Linux only
+		 * @param filePath Path to file
+		 * @param step Step in bytes. 0 disables preallocation
+		 */
+		void setPreallocation(const std::filesystem::path& filePath, uint64_t step);
+
+		/// @brief Preallocation step getter
+		/// @param filePath Path to file
+		/// @return Step in bytes
+		uint64_t getPreallocation(const std::filesystem::path& filePath);
+
 		/// @brief Cache getter
 		/// @return Cache instance
 		Cache& getCache();
@@ -244,10 +545,367 @@ namespace file_manager
 		/// @return Cache instance
 		const Cache& getCache() const;
 
+		/// @brief Descriptor cache getter
+		/// @return Descriptor cache instance
+		DescriptorCache& getDescriptorCache();
+
+		/// @brief Descriptor cache getter
+		/// @return Descriptor cache instance
+		const DescriptorCache& getDescriptorCache() const;
+
+		friend class FileNode;
 		friend class FileHandle;
 		friend class ReadFileHandle;
 		friend class WriteFileHandle;
 		friend class Cache;
 		friend struct std::default_delete<FileManager>;
+
+		template<typename HandleT, typename OperationT>
+		friend class FileRequestAwaitable;
+
+		friend class BatchRequest;
+		friend class _utility::FileIoOperation;
 	};
+
+	template<typename HandleT, typename CallbackT>
+	std::future<void> FileManager::addRequest(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		constexpr RequestType type = _utility::requestType<HandleT>;
+		FileNode* node = this->getNode(filePath, type == RequestType::read);
+
+		std::promise<void> requestPromise(std::allocator_arg, _utility::RequestAllocator<void>());
+		std::future<void> isReady = requestPromise.get_future();
+
+		if (wait && node->tryAcquireImmediately(type))
+		{
+			if constexpr (type == RequestType::write)
+			{
+				cache.clear(filePath);
+			}
+
+			// Future is ready as if request was queued, so exceptions reach caller through it
+			try
+			{
+				FileManager::execute<HandleT>(node, callback, false);
+			}
+			catch (...)
+			{
+				requestPromise.set_exception(std::current_exception());
+
+				return isReady;
+			}
+
+			requestPromise.set_value();
+
+			return isReady;
+		}
+
+		node->addRequest
+		(
+			[callback = std::forward<CallbackT>(callback), requestPromise = std::move(requestPromise)](FileNode* node) mutable
+			{
+				FileNode::GroupCommitScope scope(node);
+
+				try
+				{
+					FileManager::execute<HandleT>(node, callback, true);
+				}
+				catch (...)
+				{
+					requestPromise.set_exception(std::current_exception());
+
+					return;
+				}
+
+				if (!scope.isDeferred())
+				{
+					requestPromise.set_value();
+
+					return;
+				}
+
+				// Future completes when group sync covering this write finishes, worker is free meanwhile
+				scope.commit
+				(
+					[requestPromise = std::move(requestPromise)](std::exception_ptr exception) mutable
+					{
+						if (exception)
+						{
+							requestPromise.set_exception(exception);
+						}
+						else
+						{
+							requestPromise.set_value();
+						}
+					}
+				);
+			},
+			type
+		);
+
+		node->processQueue();
+
+		if (wait)
+		{
+			isReady.wait();
+		}
+
+		return isReady;
+	}
+
+	template<typename HandleT, typename CallbackT>
+	uint64_t FileManager::execute(FileNode* node, CallbackT& callback, bool isQueued)
+	{
+		if constexpr (std::invocable<CallbackT&, HandleT&>)
+		{
+			HandleT handle(node);
+
+			callback(handle);
+
+			// Explicit release reports sync errors that destructor would swallow
+			if (isQueued)
+			{
+				FileNode::HandoffScope scope;
+
+				handle.release();
+			}
+			else
+			{
+				handle.release();
+			}
+
+			return handle.getTransferredBytes();
+		}
+		else
+		{
+			std::unique_ptr<_utility::BaseFileHandle<HandleT>> handle(new HandleT(node));
+			uint64_t transferredBytes = 0;
+
+			callback(std::move(handle));
+
+			if (!handle)
+			{
+				return transferredBytes;
+			}
+
+			transferredBytes = handle->getTransferredBytes();
+
+			if (isQueued)
+			{
+				FileNode::HandoffScope scope;
+
+				handle->release();
+			}
+			else
+			{
+				handle->release();
+			}
+
+			return transferredBytes;
+		}
+	}
+
+	template<typename HandleT, _utility::FileCallback<HandleT> CallbackT>
+	void FileManager::submitRequest(const std::filesystem::path& filePath, CallbackT&& callback, CompletionQueue& completionQueue, uint64_t userTag)
+	{
+		constexpr RequestType type = _utility::requestType<HandleT>;
+		FileNode* node = nullptr;
+
+		try
+		{
+			node = this->getNode(filePath, type == RequestType::read);
+		}
+		catch (...)
+		{
+			completionQueue.post({ userTag, CompletionQueue::getStatus(std::current_exception()), 0 });
+
+			return;
+		}
+
+		node->addRequest
+		(
+			[callback = std::forward<CallbackT>(callback), &completionQueue, userTag](FileNode* node) mutable
+			{
+				CompletionQueue::Completion completion = { userTag, CompletionQueue::Status::success, 0 };
+
+				try
+				{
+					completion.bytes = FileManager::execute<HandleT>(node, callback, true);
+				}
+				catch (...)
+				{
+					completion.status = CompletionQueue::getStatus(std::current_exception());
+				}
+
+				completionQueue.post(completion);
+			},
+			type
+		);
+
+		node->processQueue();
+	}
+
+	template<_utility::FileCallback<ReadTextFileHandle> CallbackT>
+	std::future<void> FileManager::readFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<ReadTextFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<_utility::FileCallback<ReadBinaryFileHandle> CallbackT>
+	std::future<void> FileManager::readBinaryFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<ReadBinaryFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<_utility::FileCallback<MappedFileHandle> CallbackT>
+	std::future<void> FileManager::readMappedFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<MappedFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<_utility::FileCallback<PositionalReadFileHandle> CallbackT>
+	std::future<void> FileManager::readPositionalFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<PositionalReadFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<_utility::FileCallback<DirectReadFileHandle> CallbackT>
+	std::future<void> FileManager::readDirectFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<DirectReadFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<_utility::FileCallback<WriteTextFileHandle> CallbackT>
+	std::future<void> FileManager::writeFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<WriteTextFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<_utility::FileCallback<AppendFileHandle> CallbackT>
+	std::future<void> FileManager::appendFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<AppendFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<_utility::FileCallback<WriteBinaryFileHandle> CallbackT>
+	std::future<void> FileManager::writeBinaryFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<WriteBinaryFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<_utility::FileCallback<DirectWriteFileHandle> CallbackT>
+	std::future<void> FileManager::writeDirectFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<DirectWriteFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<_utility::FileCallback<ReplaceTextFileHandle> CallbackT>
+	std::future<void> FileManager::replaceFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<ReplaceTextFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<_utility::FileCallback<ReplaceBinaryFileHandle> CallbackT>
+	std::future<void> FileManager::replaceBinaryFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<ReplaceBinaryFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<_utility::FileCallback<AppendBinaryFileHandle> CallbackT>
+	std::future<void> FileManager::appendBinaryFile(const std::filesystem::path& filePath, CallbackT&& callback, bool wait)
+	{
+		return this->addRequest<AppendBinaryFileHandle>(filePath, std::forward<CallbackT>(callback), wait);
+	}
+
+	template<typename HandleT, _utility::FileCallback<HandleT> CallbackT>
+	BatchRequest BatchRequest::create(const std::filesystem::path& filePath, CallbackT&& callback)
+	{
+		return BatchRequest
+		(
+			filePath,
+			[callback = std::forward<CallbackT>(callback)](FileNode* node) mutable
+			{
+				FileManager::execute<HandleT>(node, callback, true);
+			},
+			_utility::requestType<HandleT>
+		);
+	}
+
+	template<typename HandleT, std::invocable<HandleT&> OperationT>
+	FileRequestAwaitable<HandleT, std::decay_t<OperationT>> FileManager::asyncRequest(const std::filesystem::path& filePath, OperationT&& operation)
+	{
+		return FileRequestAwaitable<HandleT, std::decay_t<OperationT>>(*this, filePath, std::decay_t<OperationT>(std::forward<OperationT>(operation)));
+	}
+
+	template<typename HandleT, typename OperationT>
+	FileRequestAwaitable<HandleT, OperationT>::FileRequestAwaitable(FileManager& manager, const std::filesystem::path& filePath, OperationT&& operation) :
+		manager(manager),
+		filePath(filePath),
+		operation(std::move(operation))
+	{
+
+	}
+
+	template<typename HandleT, typename OperationT>
+	bool FileRequestAwaitable<HandleT, OperationT>::await_ready() const noexcept
+	{
+		return false;
+	}
+
+	template<typename HandleT, typename OperationT>
+	void FileRequestAwaitable<HandleT, OperationT>::await_suspend(std::coroutine_handle<> coroutine)
+	{
+		constexpr FileNode::RequestType type = _utility::requestType<HandleT>;
+		FileNode* node = manager.getNode(filePath, type == FileNode::RequestType::read);
+
+		node->addRequest
+		(
+			[this, coroutine](FileNode* node)
+			{
+				auto callback = [this](HandleT& handle)
+					{
+						if constexpr (std::is_void_v<ResultT>)
+						{
+							operation(handle);
+
+							result.emplace();
+						}
+						else
+						{
+							result.emplace(operation(handle));
+						}
+					};
+
+				try
+				{
+					// Released without handoff, otherwise resumed coroutine could wait for request that is handed off to this thread
+					FileManager::execute<HandleT>(node, callback, false);
+				}
+				catch (...)
+				{
+					exception = std::current_exception();
+				}
+
+				coroutine.resume();
+			},
+			type
+		);
+
+		// Awaitable may be already destroyed by resumed coroutine
+		node->processQueue();
+	}
+
+	template<typename HandleT, typename OperationT>
+	typename FileRequestAwaitable<HandleT, OperationT>::ResultT FileRequestAwaitable<HandleT, OperationT>::await_resume()
+	{
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+
+		if constexpr (!std::is_void_v<ResultT>)
+		{
+			return std::move(*result);
+		}
+	}
 }
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <filesystem>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <system_error>
+#include <exception>
+
+#include "Utility.h"
+#include "MPSCQueue.h"
+#include "MoveOnlyFunction.h"
+
+namespace file_manager
+{
+	/// @brief Requests queue and access state of single file. Resolved once per request and referenced by its handle
+	class FILE_MANAGER_API FileNode
+	{
+	public:
+		enum class RequestType
+		{
+			read,
+			write,
+			replace ///< Write to temporary file that is renamed over file. Excludes writers and other replaces, but not readers
+		};
+
+#ifdef __LINUX__
+		using NativeHandle = int;
+#else
+		using NativeHandle = void*;
+#endif
+
+		/// @brief Executes admitted request: creates handle, calls user callback, releases handle and completes request
+		using RequestCallback = _utility::MoveOnlyFunction<void(FileNode*)>;
+
+		/// @brief Completes request once its data is durable. Gets exception if sync failed
+		using CommitCallback = _utility::MoveOnlyFunction<void(std::exception_ptr)>;
+
+		/// @brief Queued request. Allocated in RequestArena
+		struct RequestStruct : public _utility::MPSCQueueNode
+		{
+			RequestCallback callback;
+			RequestType type;
+
+			RequestStruct(RequestCallback&& callback, RequestType type);
+
+			static void* operator new(size_t size);
+
+			static void operator delete(void* block) noexcept;
+		};
+
+		/// @brief While alive, requests admitted by handle release on current thread may be handed off to it. Only has effect inside request execution
+		class FILE_MANAGER_API HandoffScope
+		{
+		private:
+			bool previous; ///< Restored when scope ends, so inner scope doesn't change outer one
+
+		public:
+			/// @param isEnabled If false requests admitted meanwhile go to thread pool even inside outer scope
+			HandoffScope(bool isEnabled = true);
+
+			HandoffScope(const HandoffScope&) = delete;
+
+			HandoffScope& operator = (const HandoffScope&) = delete;
+
+			~HandoffScope();
+		};
+
+		/// @brief While alive, writer of scope node released on current thread with group commit does not wait for sync. Owner completes request with commit instead
+		class FILE_MANAGER_API GroupCommitScope
+		{
+		private:
+			FileNode* node;
+			uint64_t ticket;
+			GroupCommitScope* previous;
+
+		public:
+			GroupCommitScope(FileNode* node);
+
+			GroupCommitScope(const GroupCommitScope&) = delete;
+
+			GroupCommitScope& operator = (const GroupCommitScope&) = delete;
+
+			/// @brief Pass group commit ticket of released writer to current scope
+			/// @return False if there is no scope for this node, then writer has to wait itself
+			static bool defer(FileNode* node, uint64_t ticket);
+
+			/// @brief Check if released writer joined group commit
+			bool isDeferred() const;
+
+			/// @brief Call callback once data of released writer is durable. Callback may be called on this or syncing thread
+			void commit(CommitCallback&& callback);
+
+			~GroupCommitScope();
+		};
+
+		/// @brief While alive, requests admitted on current thread are collected instead of being posted to thread pool one by one. On destruction they are split between workers, one thread pool task per worker
+		class FILE_MANAGER_API BatchScope
+		{
+		private:
+			std::vector<std::pair<FileNode*, RequestStruct*>> requests;
+			std::vector<std::pair<FileNode*, RequestStruct*>>* previous;
+
+		public:
+			BatchScope();
+
+			BatchScope(const BatchScope&) = delete;
+
+			BatchScope& operator = (const BatchScope&) = delete;
+
+			~BatchScope();
+		};
+
+	private:
+		static constexpr size_t maxHandoffs = 64;
+		static constexpr uint64_t writerBit = 1ULL << 63;
+		static constexpr uint64_t writerWaitingBit = 1ULL << 62;
+		static constexpr uint64_t replacerBit = 1ULL << 61;
+		static constexpr uint64_t readersMask = replacerBit - 1;
+
+	private:
+		std::filesystem::path filePath;
+		_utility::MPSCQueue<RequestStruct> requests;
+		RequestStruct* blockedRequest;
+		std::atomic_size_t dispatchRequests;
+		std::atomic_size_t queuedRequests;
+		std::atomic_uint64_t state; ///< Active readers count, writerBit for active writer, writerWaitingBit for writer that waits for readers and replacerBit for active replace
+		std::mutex readDescriptorMutex;
+		NativeHandle readDescriptor;
+		size_t readDescriptorUsers;
+		std::vector<std::pair<NativeHandle, size_t>> retiredReadDescriptors; ///< Descriptors of replaced file that are still used by readers
+		std::mutex groupCommitMutex;
+		std::condition_variable groupCommitCondition;
+		uint64_t groupCommitWrites; ///< Writes that joined group commit
+		uint64_t syncedWrites; ///< Writes covered by successful sync
+		uint64_t failedWrites; ///< Writes covered by failed sync
+		std::error_code groupCommitError;
+		std::vector<std::pair<uint64_t, CommitCallback>> pendingCommits;
+		bool isGroupSyncing;
+		std::atomic_uint64_t preallocationStep;
+		uint64_t allocatedEnd; ///< End of space allocated past end of file by preallocate. Used by active writer only
+		uint64_t appendedEnd; ///< End of file after last preallocated append. File shrank if next append starts before it
+
+	private:
+		/// @brief Sync file until no callbacks are pending. Called with groupCommitMutex locked by thread that set isGroupSyncing
+		void syncGroups(std::unique_lock<std::mutex>& lock);
+
+		/// @brief Admit reader if there is no active or waiting writer
+		bool tryAcquireRead();
+
+		/// @brief Admit writer if file is idle, otherwise mark writer as waiting so new readers queue behind it
+		bool tryAcquireWrite();
+
+		/// @brief Admit replace if there is no active writer or replace. Active readers are not waited for
+		bool tryAcquireReplace();
+
+		/// @brief Admit requests from queue head until one of them has to wait. Called only by current dispatcher
+		void dispatch();
+
+		/// @brief Pass admitted request to releasing worker if it can take it, otherwise to thread pool
+		void submit(RequestStruct* request);
+
+		/// @brief Execute request and requests handed off to this thread meanwhile
+		void run(RequestStruct* request);
+
+		/// @brief Post admitted requests to thread pool as one task per worker
+		static void submitBatch(std::vector<std::pair<FileNode*, RequestStruct*>>&& requests);
+
+	public:
+		FileNode(const std::filesystem::path& filePath);
+
+		FileNode(const FileNode&) = delete;
+
+		FileNode& operator = (const FileNode&) = delete;
+
+		/// @brief Add request to queue. Call processQueue after that
+		/// @param callback Request executor
+		/// @param type Request type
+		void addRequest(RequestCallback&& callback, RequestType type);
+
+		/// @brief Admit request that bypasses queue. Succeeds only if nothing is queued and file is free for this request type
+		/// @param type Request type
+		/// @return True if request admitted. Caller must release it with completeReadRequest, completeWriteRequest or completeReplaceRequest
+		bool tryAcquireImmediately(RequestType type);
+
+		/// @brief Dispatch admissible requests. Whoever finds no active dispatcher drains the queue, other callers only ask it for one more pass
+		void processQueue();
+
+		/// @brief Release reader. Last reader hands file over to waiting writer
+		void completeReadRequest();
+
+		/// @brief Release writer and dispatch queued requests
+		void completeWriteRequest();
+
+		/// @brief Release replace and dispatch queued requests
+		void completeReplaceRequest();
+
+		/**
+		 * @brief Rename file over this file. Called by replace request
+		 * Active readers keep previous file, descriptors acquired after that refer to new one
+		 * @param sourcePath Path to file in the same directory
+		 * @param isDurable If true directory is synced, so rename survives crash
+		 * @exception std::system_error
+		 */
+		void replace(const std::filesystem::path& sourcePath, bool isDurable);
+
+		/// @brief Get read only descriptor shared by concurrent positional readers. First reader takes it from FileManager descriptor cache, last reader returns it in releaseReadDescriptor
+		/// @return Native file descriptor
+		/// @exception std::system_error if file can't be opened
+		NativeHandle acquireReadDescriptor();
+
+		/// @brief Release descriptor taken with acquireReadDescriptor. Unknown descriptor fails assertion in debug builds and is ignored otherwise
+		/// @param descriptor Acquired descriptor. It differs from current one if file was replaced meanwhile
+		void releaseReadDescriptor(NativeHandle descriptor);
+
+		/// @brief Flush file data to storage with fdatasync or fsync
+		/// @param isFull If true metadata is flushed too
+		/// @exception std::system_error
+		void sync(bool isFull);
+
+		/// @brief Join next group commit. Called by writer after its data is written and before it releases file
+		/// @return Ticket for waitGroupCommit
+		uint64_t joinGroupCommit();
+
+		/**
+		 * @brief Call callback once data of writer is durable. Called after writer releases file, so following writers proceed meanwhile
+		 * If no sync is running caller syncs file for all joined writers until nothing is pending, otherwise callback is called by syncing thread
+		 * @param ticket Ticket from joinGroupCommit
+		 * @param callback Completion
+		 */
+		void commitGroup(uint64_t ticket, CommitCallback&& callback);
+
+		/// @brief Block until data of writer is durable. Same as commitGroup for callers that can't defer completion
+		/// @param ticket Ticket from joinGroupCommit
+		/// @exception std::system_error if sync covering the ticket failed
+		void waitGroupCommit(uint64_t ticket);
+
+		/**
+		 * @brief Allocate space past end of file with fallocate in steps, so small appends don't grow file extent by extent and update its metadata every time
+		 * File size is kept. Called by active append writer. Does nothing on Windows
+		 * @param descriptor Append descriptor of writer
+		 * @param offset End of file before appended data
+		 * @param end End of file after appended data
+		 * @param step Allocation step
+		 */
+		void preallocate(NativeHandle descriptor, uint64_t offset, uint64_t end, uint64_t step);
+
+		/// @brief Free space allocated past end of file by preallocate. Called by active writer, e.g. before file is rotated, and on destruction
+		void trimPreallocation();
+
+		/// @brief Set preallocation step of append requests. 0 disables preallocation
+		/// @param step Step in bytes
+		void setPreallocationStep(uint64_t step);
+
+		/// @brief Preallocation step of append requests
+		/// @return Step in bytes
+		uint64_t getPreallocationStep() const;
+
+		const std::filesystem::path& getPathToFile() const;
+
+		~FileNode();
+	};
+}
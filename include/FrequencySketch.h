@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Utility.h"
+
+namespace file_manager::_utility
+{
+	/**
+	 * @brief Count-Min sketch of access frequencies with 4-bit counters, used by Cache admission
+	 * Each key owns one counter in each of 4 table words, estimate is minimum of them
+	 * All counters are halved after sample of increments, so popularity of old keys fades
+	 */
+	class FILE_MANAGER_API FrequencySketch
+	{
+	public:
+		/// @brief Saturation value of counter
+		static constexpr uint32_t maxFrequency = 15;
+
+		/// @brief Min count of table words
+		static constexpr size_t minimumSize = 16;
+
+	private:
+		std::vector<uint64_t> table;
+		size_t sampleSize;
+		size_t additions;
+
+	private:
+		static uint64_t spread(size_t hash);
+
+		size_t indexOf(uint64_t hash, size_t row) const;
+
+		void reset();
+
+	public:
+		FrequencySketch();
+
+		/// @brief Grow table to track at least entries keys. Counters are dropped on growth
+		/// @param entries Count of keys
+		void ensureCapacity(size_t entries);
+
+		/// @brief Estimated count of key increments
+		/// @param hash Hash of key
+		/// @return Frequency in [0, maxFrequency]
+		uint32_t frequency(size_t hash) const;
+
+		/// @brief Record access of key
+		/// @param hash Hash of key
+		void increment(size_t hash);
+
+		~FrequencySketch() = default;
+	};
+}
@@ -1,17 +1,3 @@
 #pragma once
 
-#include "WriteFileHandle.h"
-
-namespace file_manager
-{
-	class AppendFileHandle : public WriteFileHandle
-	{
-	private:
-		AppendFileHandle(const std::filesystem::path& filePath);
-
-	public:
-		~AppendFileHandle() = default;
-
-		friend class FileManager;
-	};
-}
+#include "BasicWriteFileHandle.h"
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ReadFileHandle.h"
+
+namespace file_manager
+{
+	/// @brief Read handle with open mode fixed at compile time. Constructed in place by request and passed to callback by reference
+	/// @tparam Mode Additional open mode. std::ios_base::in is always added
+	template<std::ios_base::openmode Mode>
+	class BasicReadFileHandle final : public ReadFileHandle
+	{
+	private:
+		BasicReadFileHandle(FileNode* node);
+
+	public:
+		static constexpr std::ios_base::openmode openMode = Mode | std::ios_base::in;
+
+	public:
+		~BasicReadFileHandle() = default;
+
+		friend class FileManager;
+	};
+
+	using ReadTextFileHandle = BasicReadFileHandle<std::ios_base::in>;
+	using ReadBinaryFileHandle = BasicReadFileHandle<std::ios_base::in | std::ios_base::binary>;
+
+	template<std::ios_base::openmode Mode>
+	BasicReadFileHandle<Mode>::BasicReadFileHandle(FileNode* node) :
+		ReadFileHandle(node, openMode)
+	{
+
+	}
+}
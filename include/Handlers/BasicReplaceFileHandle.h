@@ -0,0 +1,33 @@
+#pragma once
+
+#include "ReplaceFileHandle.h"
+
+namespace file_manager
+{
+	/// @brief Replace handle with open mode fixed at compile time. Constructed in place by request and passed to callback by reference
+	/// @tparam Mode Additional open mode. std::ios_base::out is always added
+	template<std::ios_base::openmode Mode>
+	class BasicReplaceFileHandle final : public ReplaceFileHandle
+	{
+	private:
+		BasicReplaceFileHandle(FileNode* node);
+
+	public:
+		static constexpr std::ios_base::openmode openMode = Mode | std::ios_base::out;
+
+	public:
+		~BasicReplaceFileHandle() = default;
+
+		friend class FileManager;
+	};
+
+	using ReplaceTextFileHandle = BasicReplaceFileHandle<std::ios_base::out>;
+	using ReplaceBinaryFileHandle = BasicReplaceFileHandle<std::ios_base::out | std::ios_base::binary>;
+
+	template<std::ios_base::openmode Mode>
+	BasicReplaceFileHandle<Mode>::BasicReplaceFileHandle(FileNode* node) :
+		ReplaceFileHandle(node, openMode)
+	{
+
+	}
+}
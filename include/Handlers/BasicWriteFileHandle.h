@@ -0,0 +1,35 @@
+#pragma once
+
+#include "WriteFileHandle.h"
+
+namespace file_manager
+{
+	/// @brief Write handle with open mode fixed at compile time. Constructed in place by request and passed to callback by reference
+	/// @tparam Mode Additional open mode. std::ios_base::out is always added
+	template<std::ios_base::openmode Mode>
+	class BasicWriteFileHandle final : public WriteFileHandle
+	{
+	private:
+		BasicWriteFileHandle(FileNode* node);
+
+	public:
+		static constexpr std::ios_base::openmode openMode = Mode | std::ios_base::out;
+
+	public:
+		~BasicWriteFileHandle() = default;
+
+		friend class FileManager;
+	};
+
+	using WriteTextFileHandle = BasicWriteFileHandle<std::ios_base::out>;
+	using WriteBinaryFileHandle = BasicWriteFileHandle<std::ios_base::out | std::ios_base::binary>;
+	using AppendFileHandle = BasicWriteFileHandle<std::ios_base::app>;
+	using AppendBinaryFileHandle = BasicWriteFileHandle<std::ios_base::app | std::ios_base::binary>;
+
+	template<std::ios_base::openmode Mode>
+	BasicWriteFileHandle<Mode>::BasicWriteFileHandle(FileNode* node) :
+		WriteFileHandle(node, openMode)
+	{
+
+	}
+}
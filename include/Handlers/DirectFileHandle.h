@@ -0,0 +1,56 @@
+#pragma once
+
+#include "FileHandle.h"
+#include "FileNode.h"
+#include "AlignedBufferPool.h"
+
+namespace file_manager
+{
+	/**
+	 * @brief Base of handles that bypass page cache (O_DIRECT on Linux, FILE_FLAG_NO_BUFFERING on Windows)
+	 * Data goes through aligned buffer from AlignedBufferPool, so caller's buffers may have any alignment and size
+	 * If file system does not support unbuffered I/O file is opened normally with the same behavior
+	 */
+	class FILE_MANAGER_API DirectFileHandle : public FileHandle
+	{
+	protected:
+		FileNode::NativeHandle descriptor;
+		_utility::AlignedBufferPool::Buffer buffer;
+		uint64_t fileOffset; ///< Offset of next block transfer. Aligned until end of file is reached
+		bool isDirect;
+
+	protected:
+		/// @exception std::system_error if file can't be opened
+		DirectFileHandle(FileNode* node, std::ios_base::openmode mode);
+
+		/// @brief Read blocks at fileOffset and advance it
+		/// @param data Aligned destination
+		/// @param size Aligned size
+		/// @return Bytes read. Less than size only at the end of file
+		/// @exception std::system_error
+		size_t readBlocks(std::byte* data, size_t size);
+
+		/// @brief Write blocks at fileOffset
+		/// @param data Aligned source
+		/// @param size Aligned size
+		/// @param isAdvance If false fileOffset stays the same, so blocks can be rewritten
+		/// @exception std::system_error
+		void writeBlocks(const std::byte* data, size_t size, bool isAdvance = true);
+
+		/// @brief Set file size
+		/// @exception std::system_error
+		void truncate(uint64_t size);
+
+		/// @brief Close descriptor before releasing node
+		void release() override;
+
+	public:
+		/// @brief Check if page cache is bypassed
+		/// @return False if file system does not support unbuffered I/O
+		bool isUnbuffered() const;
+
+		virtual ~DirectFileHandle();
+
+		friend class FileManager;
+	};
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <span>
+#include <string>
+
+#include "DirectFileHandle.h"
+
+namespace file_manager
+{
+	/// @brief Provides sequential reading of big binary files without polluting page cache
+	class FILE_MANAGER_API DirectReadFileHandle final : public DirectFileHandle
+	{
+	private:
+		size_t bufferBegin;
+		size_t bufferEnd;
+		bool isEndOfFile;
+
+	private:
+		DirectReadFileHandle(FileNode* node);
+
+	public:
+		static constexpr std::ios_base::openmode openMode = std::ios_base::in | std::ios_base::binary;
+
+	public:
+		/// @brief Read data from current position. Aligned part of aligned destination is read without copying
+		/// @param outData Buffer to fill
+		/// @return Number of bytes read. Less than requested only at the end of file
+		/// @exception std::system_error
+		size_t read(std::span<std::byte> outData);
+
+		/// @brief Read file from current position to the end
+		/// @return File's data
+		/// @exception std::system_error
+		std::string readAllData();
+
+		~DirectReadFileHandle() = default;
+
+		friend class FileManager;
+	};
+}
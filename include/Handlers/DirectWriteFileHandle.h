@@ -0,0 +1,50 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+
+#include "DirectFileHandle.h"
+
+namespace file_manager
+{
+	/**
+	 * @brief Provides sequential writing of big binary files without polluting page cache. File is created or recreated
+	 * Data is collected in aligned buffer and written in whole blocks. Unaligned tail is written as padded block and file is truncated to its real size
+	 */
+	class FILE_MANAGER_API DirectWriteFileHandle final : public DirectFileHandle
+	{
+	private:
+		size_t bufferedBytes;
+
+	private:
+		DirectWriteFileHandle(FileNode* node);
+
+		/// @brief Write whole blocks of buffer and move the rest to buffer start
+		void writeBuffer();
+
+		/// @brief Flush tail ignoring errors, then release node
+		void release() override;
+
+	public:
+		static constexpr std::ios_base::openmode openMode = std::ios_base::out | std::ios_base::binary;
+
+	public:
+		/// @brief Write data to file. Aligned part of aligned data is written without copying if nothing is buffered
+		/// @param data Data
+		/// @exception std::system_error
+		void write(std::span<const std::byte> data);
+
+		/// @brief Write data to file
+		/// @param data Data
+		/// @exception std::system_error
+		void write(std::string_view data);
+
+		/// @brief Write buffered data including unaligned tail. Called on release, call it explicitly to get errors
+		/// @exception std::system_error
+		void flush();
+
+		~DirectWriteFileHandle();
+
+		friend class FileManager;
+	};
+}
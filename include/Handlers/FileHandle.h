@@ -6,21 +6,30 @@
 
 namespace file_manager
 {
+	class FileNode;
+
 	class FILE_MANAGER_API FileHandle
 	{
 	protected:
-		std::filesystem::path filePath;
+		FileNode* node;
 		std::fstream file;
 		std::ios_base::openmode mode;
+		uint64_t transferredBytes;
 		bool isNotifyOnDestruction;
 
 	protected:
-		FileHandle(const std::filesystem::path& filePath, std::ios_base::openmode mode);
+		FileHandle(FileNode* node, std::ios_base::openmode mode);
+
+		/// @brief Read handle that accesses file natively without std::fstream
+		FileHandle(FileNode* node);
 
 		FileHandle(FileHandle&& other) noexcept;
 
 		FileHandle& operator = (FileHandle&& other) noexcept;
 
+		/// @brief Close file and release node. Does nothing if handle is already released
+		virtual void release();
+
 	public:
 		FileHandle(const FileHandle&) = delete;
 
@@ -32,6 +41,9 @@ namespace file_manager
 
 		std::filesystem::path getFileName() const;
 
+		/// @brief Bytes read or written through handle methods. Direct stream access is not counted
+		uint64_t getTransferredBytes() const;
+
 		virtual ~FileHandle();
 
 		friend class FileManager;
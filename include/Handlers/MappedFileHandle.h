@@ -0,0 +1,52 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+
+#include "FileHandle.h"
+
+namespace file_manager
+{
+	/// @brief Provides zero copy reading of memory mapped file. Mapping is valid for handle lifetime, file is protected from writers by reader lock
+	class FILE_MANAGER_API MappedFileHandle final : public FileHandle
+	{
+	public:
+		/// @brief Expected access pattern. Passed to madvise on Linux
+		enum class Advice
+		{
+			normal,
+			sequential,
+			random,
+			willNeed ///< Start reading pages in background
+		};
+
+	private:
+		const std::byte* data;
+		size_t size;
+#ifndef __LINUX__
+		void* mapping;
+#endif
+
+	private:
+		MappedFileHandle(FileNode* node);
+
+	public:
+		/// @brief Get file data
+		/// @return Mapped file data. Empty for empty file
+		std::span<const std::byte> getData() const;
+
+		/// @brief Get file data as characters
+		/// @return Mapped file data. Empty for empty file
+		std::string_view getView() const;
+
+		/// @brief Hint expected access pattern of file range. Mapping is created with Advice::sequential
+		/// @param advice Access pattern
+		/// @param offset Range start
+		/// @param count Range size. By default till the end of file
+		void advise(Advice advice, size_t offset = 0, size_t count = std::string_view::npos);
+
+		~MappedFileHandle();
+
+		friend class FileManager;
+	};
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <span>
+#include <string>
+
+#include "FileHandle.h"
+#include "FileNode.h"
+
+namespace file_manager
+{
+	/// @brief Provides reading at explicit offsets. Concurrent readers of the same file share one descriptor owned by FileNode, handle has no position of its own
+	class FILE_MANAGER_API PositionalReadFileHandle final : public FileHandle
+	{
+	private:
+		FileNode::NativeHandle descriptor;
+
+	private:
+		PositionalReadFileHandle(FileNode* node);
+
+		/// @brief Return shared descriptor before releasing node, so readers admitted after next writer take it again through descriptor cache check
+		void release() override;
+
+	public:
+		/// @brief Read data at offset. Reads less than requested only at the end of file
+		/// @param outData Buffer to fill
+		/// @param offset Offset from file start
+		/// @return Number of bytes read
+		/// @exception std::system_error
+		size_t read(std::span<std::byte> outData, uint64_t offset);
+
+		/// @brief Read data at offset
+		/// @param offset Offset from file start
+		/// @param count Count of bytes to read
+		/// @return Data from file. Shorter than count if end of file is reached
+		/// @exception std::system_error
+		std::string readData(uint64_t offset, size_t count);
+
+		/// @brief Read all file
+		/// @return File's data
+		/// @exception std::system_error
+		std::string readAllData();
+
+		~PositionalReadFileHandle();
+
+		friend class FileManager;
+	};
+}
@@ -1,17 +1,3 @@
 #pragma once
 
-#include "ReadFileHandle.h"
-
-namespace file_manager
-{
-	class ReadBinaryFileHandle : public ReadFileHandle
-	{
-	private:
-		ReadBinaryFileHandle(const std::filesystem::path& filePath);
-
-	public:
-		~ReadBinaryFileHandle() = default;
-
-		friend class FileManager;
-	};
-}
+#include "BasicReadFileHandle.h"
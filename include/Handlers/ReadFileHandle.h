@@ -2,14 +2,28 @@
 
 #include <functional>
 #include <sstream>
+#include <optional>
+#include <memory>
 
 #include "FileHandle.h"
+#include "DescriptorBuffer.h"
 
 namespace file_manager
 {
 	/// @brief Provides reading files
 	class FILE_MANAGER_API ReadFileHandle : public FileHandle
 	{
+	public:
+		/// @brief How request reads file. Applied with posix_fadvise, ignored on Windows and for cached files
+		enum class AccessPattern
+		{
+			normal, ///< Default readahead
+			sequential, ///< Bigger readahead
+			random, ///< No readahead, e.g. index files
+			willNeed, ///< Start reading whole file into page cache in background
+			dontNeed ///< One-shot scan: sequential readahead and file pages are dropped from page cache when request completes
+		};
+
 	private:
 		class ReadOnlyBuffer : public std::stringbuf
 		{
@@ -19,13 +33,21 @@ namespace file_manager
 
 	private:
 		std::string data;
-		std::unique_ptr<ReadOnlyBuffer> buffer;
+		std::shared_ptr<const std::string> cachedData; ///< Keeps cached data alive if file is replaced while handle reads it
+		std::optional<ReadOnlyBuffer> buffer;
+#ifdef __LINUX__
+		_utility::DescriptorBuffer descriptorBuffer; ///< Not open if file is cached, readahead hints apply only to descriptor they are given
+#endif
+		AccessPattern accessPattern;
 
 	protected:
-		ReadFileHandle(const std::filesystem::path& filePath, std::ios_base::openmode mode = std::ios_base::in);
+		ReadFileHandle(FileNode* node, std::ios_base::openmode mode = std::ios_base::in);
+
+		/// @brief Drop file pages from page cache for AccessPattern::dontNeed, give descriptor back to DescriptorCache and release node
+		void release() override;
 
 	public:
-		/// @brief Read all file
+		/// @brief Read all file from its start. File that is not cached is read through request stream, so access pattern applies to it
 		/// @return File's data
 		/// @exception FileDoesNotExistException
 		const std::string& readAllData();
@@ -42,6 +64,14 @@ namespace file_manager
 		/// @return Input stream
 		std::istream& getStream();
 
+		/// @brief Declare how file is going to be read. Call before reading, stream keeps its position
+		/// @param accessPattern Access pattern
+		void setAccessPattern(AccessPattern accessPattern);
+
+		/// @brief Access pattern getter
+		/// @return Current access pattern
+		AccessPattern getAccessPattern() const;
+
 		virtual ~ReadFileHandle();
 
 		friend class FileManager;
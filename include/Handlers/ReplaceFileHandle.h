@@ -0,0 +1,46 @@
+#pragma once
+
+#include "WriteFileHandle.h"
+
+namespace file_manager
+{
+	/**
+	 * @brief Writes file atomically. Data goes to temporary file in the same directory that is synced and renamed over file on release
+	 * Readers active meanwhile keep previous file, so replace doesn't wait for them and no reader sees partially written file
+	 * If callback throws or writing fails, temporary file is removed and file is left unchanged
+	 */
+	class FILE_MANAGER_API ReplaceFileHandle : public WriteFileHandle
+	{
+	private:
+		std::filesystem::path temporaryPath;
+		int uncaughtExceptions;
+
+	private:
+		/// @brief Unique hidden sibling of file
+		static std::filesystem::path makeTemporaryPath(const std::filesystem::path& filePath);
+
+		ReplaceFileHandle(FileNode* node, std::ios_base::openmode mode, std::filesystem::path&& temporaryPath);
+
+		/// @brief Remove temporary file and release node leaving file unchanged
+		void discard();
+
+	protected:
+		ReplaceFileHandle(FileNode* node, std::ios_base::openmode mode);
+
+		/**
+		 * @brief Sync temporary file, rename it over file and update cache
+		 * Durability other than none also syncs directory, so replace survives crash. Group commit is the same as data sync here
+		 * @exception std::system_error if writing, sync or rename fails. File is unchanged then
+		 */
+		void release() override;
+
+	public:
+		/// @brief Temporary file that receives data until release
+		/// @return Path to temporary file
+		const std::filesystem::path& getTemporaryPath() const;
+
+		virtual ~ReplaceFileHandle();
+
+		friend class FileManager;
+	};
+}
@@ -1,17 +1,3 @@
 #pragma once
 
-#include "WriteFileHandle.h"
-
-namespace file_manager
-{
-	class WriteBinaryFileHandle : public WriteFileHandle
-	{
-	protected:
-		WriteBinaryFileHandle(const std::filesystem::path& filePath, std::ios_base::openmode mode = std::ios_base::out | std::ios_base::binary);
-
-	public:
-		virtual ~WriteBinaryFileHandle() = default;
-
-		friend class FileManager;
-	};
-}
+#include "BasicWriteFileHandle.h"
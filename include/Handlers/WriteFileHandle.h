@@ -1,8 +1,15 @@
 #pragma once
 
 #include <functional>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <initializer_list>
 
 #include "FileHandle.h"
+#include "DescriptorBuffer.h"
 
 namespace file_manager
 {
@@ -11,34 +18,180 @@ namespace file_manager
 	/// @brief Provides writing files
 	class FILE_MANAGER_API WriteFileHandle : public FileHandle
 	{
+	public:
+		/// @brief When request completes relative to data reaching storage
+		enum class Durability
+		{
+			none, ///< Data is in page cache when request completes
+			dataSync, ///< fdatasync after close
+			fullSync, ///< fsync after close, metadata is flushed too
+			groupCommit ///< fdatasync shared by writers of the file that complete close together. File is released before sync, so next writer proceeds meanwhile
+		};
+
+		/// @brief When write methods flush stream buffer to file. Close always flushes
+		struct FlushPolicy
+		{
+			enum class Type
+			{
+				perCall, ///< Flush after every write call
+				bytes, ///< Flush when at least threshold bytes are written since last flush
+				interval, ///< Flush on write call if at least interval passed since last flush
+				onClose ///< Flush only when stream buffer is full and on close
+			};
+
+			Type type = Type::perCall;
+			uint64_t threshold = 0;
+			std::chrono::milliseconds interval = std::chrono::milliseconds(0);
+
+			static FlushPolicy perCall();
+
+			static FlushPolicy everyBytes(uint64_t threshold);
+
+			static FlushPolicy every(std::chrono::milliseconds interval);
+
+			static FlushPolicy onClose();
+		};
+
+		/// @brief Space allocated ahead of appended data. Only append requests on Linux preallocate
+		struct Preallocation
+		{
+			uint64_t step = 0; ///< Space allocated past end of file at once with fallocate keeping file size. 0 disables preallocation
+			bool isTrimmedOnClose = false; ///< Free space past end of file when request completes, e.g. last append before file is rotated
+		};
+
 	private:
-		class CachingBuffer : public std::filebuf
+#ifdef __LINUX__
+		/// @brief Node file descriptor comes from DescriptorCache
+		using FileBuffer = _utility::DescriptorBuffer;
+#else
+		using FileBuffer = std::filebuf;
+#endif
+
+		/// @brief File buffer that collects written data and puts it to cache on close if it fits. Data is taken when it leaves put area, so writes through getStream are cached too
+		class CachingBuffer : public FileBuffer
 		{
 		private:
 			Cache& cache;
 			std::filesystem::path filePath;
 			std::string cacheData;
+			size_t recordedBytes; ///< Put area prefix that is already in cacheData
 			bool isCachingAvailable;
+			bool isInsideWrite;
 
 		private:
-			bool increaseCacheData();
+			/// @brief Take not yet taken data from put area and reserve cache size for it
+			/// @param data Data that follows put area
+			bool increaseCacheData(std::string_view data = std::string_view());
 
-		public:
-			CachingBuffer(class Cache& cache, const std::filesystem::path& filePath, std::ios_base::openmode mode);
+		protected:
+			std::streamsize xsputn(const char* data, std::streamsize count) override;
+
+			int_type overflow(int_type character) override;
 
 			int sync() override;
 
+		public:
+			/// @param node Node of file whose cache is filled
+			/// @param writePath Path to opened file. Differs from node file if file is replaced by writing another one
+			CachingBuffer(class Cache& cache, FileNode* node, const std::filesystem::path& writePath, std::ios_base::openmode mode, char* buffer, size_t bufferSize);
+
+			/// @brief Close file and put collected data to cache
+			CachingBuffer* close();
+
+			/// @brief Close file keeping collected data until commitCache
+			/// @return False if pending data can't be written
+			bool closeFile();
+
+			/// @brief Close file and drop collected data, e.g. when file is removed
+			void discard();
+
+#ifdef __LINUX__
+			/// @brief Take buffers and write them with DescriptorBuffer::writeVectored
+			bool writeVectored(std::span<const std::string_view> buffers);
+#endif
+
+			/// @brief Put collected data to cache or drop it
+			/// @param isWritten If false reserved cache size is released
+			/// @return True if data is put to cache
+			bool commitCache(bool isWritten);
+
 			~CachingBuffer();
 		};
 
+	private:
+		std::unique_ptr<char[]> bufferData;
+		CachingBuffer buffer;
+		FlushPolicy flushPolicy;
+		Durability durability;
+		Preallocation preallocation;
+		uint64_t appendEnd; ///< End of file after data written so far, unknownEnd before first preallocation
+		uint64_t unflushedBytes;
+		std::chrono::steady_clock::time_point lastFlush;
+
+	private:
+		static constexpr uint64_t unknownEnd = std::numeric_limits<uint64_t>::max();
+
+	private:
+		/// @brief Flush if flush policy requires it
+		void flushIfNeeded(uint64_t writtenBytes);
+
+		/// @brief Allocate space for data that is going to be appended according to preallocation
+		void preallocate(uint64_t bytes);
+
 	protected:
-		WriteFileHandle(const std::filesystem::path& filePath, std::ios_base::openmode mode = std::ios_base::out);
+		WriteFileHandle(FileNode* node, std::ios_base::openmode mode = std::ios_base::out);
+
+		/// @param writePath Path to opened file, data is cached for node file
+		WriteFileHandle(FileNode* node, const std::filesystem::path& writePath, std::ios_base::openmode mode);
+
+		/// @brief Close file, cache written data, trim preallocated space and sync it according to durability. Node is released even if sync fails
+		/// @exception std::system_error if sync fails
+		void release() override;
 
 	public:
-		/// @brief Write data to file
+		/// @brief Write data to file. Flushed according to flush policy
 		/// @param data Data
 		void write(const std::string& data);
 
+		/**
+		 * @brief Write several buffers in order and flush once according to flush policy, e.g. record header, payload and trailer without concatenating them
+		 * On Linux buffers that fit into stream buffer are copied there, otherwise stream buffer and all buffers go to file in one pwritev without copying
+		 * On Windows buffers are written through std::filebuf one by one
+		 * @param buffers Data buffers
+		 */
+		void write(std::span<const std::string_view> buffers);
+
+		/// @brief Write several buffers in order and flush once according to flush policy
+		/// @param buffers Data buffers
+		void write(std::initializer_list<std::string_view> buffers);
+
+		/// @brief Flush stream buffer to file
+		void flush();
+
+		/// @brief Set when write methods flush. Default is FlushPolicy::perCall()
+		/// @param flushPolicy Flush policy
+		void setFlushPolicy(const FlushPolicy& flushPolicy);
+
+		/// @brief Flush policy getter
+		/// @return Current flush policy
+		const FlushPolicy& getFlushPolicy() const;
+
+		/// @brief Set durability of this request. Default is Durability::none
+		/// @param durability Durability level
+		void setDurability(Durability durability);
+
+		/// @brief Durability getter
+		/// @return Current durability level
+		Durability getDurability() const;
+
+		/// @brief Set preallocation of this request. Default step is FileManager::getPreallocation of file
+		/// @param preallocation Preallocation
+		void setPreallocation(const Preallocation& preallocation);
+
+		/// @brief Preallocation getter
+		/// @return Current preallocation
+		const Preallocation& getPreallocation() const;
+
 		/// @brief Get writing stream
 		/// @return Output stream
 		std::ostream& getStream();
@@ -46,5 +199,6 @@ namespace file_manager
 		virtual ~WriteFileHandle();
 
 		friend class FileManager;
+		friend class ReplaceFileHandle;
 	};
 }
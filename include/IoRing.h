@@ -0,0 +1,100 @@
+#pragma once
+
+#ifdef __LINUX__
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <semaphore>
+
+#include "Utility.h"
+
+struct io_uring_sqe;
+
+namespace file_manager::_utility
+{
+	/**
+	 * @brief io_uring instance with its own completion thread. Linux only
+	 * Submissions from many threads are appended to submission queue under mutex and passed to kernel in batches by whichever thread finds no submission in progress
+	 * Number of operations in flight is limited by queue size, so completion queue never overflows
+	 */
+	class FILE_MANAGER_API IoRing
+	{
+	public:
+		/// @brief Submitted operation. Must stay alive until complete is called
+		class Operation
+		{
+		public:
+			/// @brief Called from completion thread. May submit one next operation, it takes over entry of the completed one and never blocks
+			/// Called from submitting thread with negative errno if kernel rejects submission
+			/// @param result Bytes transferred or negative errno
+			virtual void complete(int32_t result) = 0;
+
+			virtual ~Operation() = default;
+		};
+
+	private:
+		struct Queue
+		{
+			uint32_t* head;
+			uint32_t* tail;
+			uint32_t mask;
+		};
+
+	private:
+		int ringDescriptor;
+		void* submissionRing;
+		void* completionRing;
+		size_t submissionRingSize;
+		size_t completionRingSize;
+		io_uring_sqe* submissionEntries;
+		size_t submissionEntriesSize;
+		uint32_t* submissionArray;
+		Queue submissionQueue;
+		Queue completionQueue;
+		void* completionEntries;
+		uint32_t entries;
+		std::mutex submissionMutex;
+		uint32_t pendingSubmissions;
+		bool isSubmitting;
+		bool isEntryReused; ///< Accessed only by completion thread
+		std::atomic_bool isStopping;
+		std::counting_semaphore<> availableEntries;
+		std::thread completionThread;
+
+	private:
+		void submit(uint8_t operationCode, Operation* operation, int descriptor, uint64_t address, uint32_t size, uint64_t offset);
+
+		/// @brief Take back entries kernel didn't consume and complete their operations with error. Submission must be in progress
+		/// @param lock Locked submissionMutex, unlocked on return
+		/// @param error errno of failed io_uring_enter
+		void failUnsubmitted(std::unique_lock<std::mutex>& lock, int error);
+
+		void reap();
+
+		/// @brief Unmap rings and close ring descriptor
+		void close();
+
+	public:
+		/// @brief Set up ring and start completion thread
+		/// @param entries Submission queue size and max operations in flight
+		/// @exception std::system_error io_uring is not available
+		IoRing(uint32_t entries = 256);
+
+		IoRing(const IoRing&) = delete;
+
+		IoRing& operator = (const IoRing&) = delete;
+
+		/// @brief Queue read. Blocks only while entries operations are in flight
+		/// @param offset File offset, -1 for current file position
+		void read(Operation* operation, int descriptor, void* buffer, uint32_t size, uint64_t offset);
+
+		/// @brief Queue write. Blocks only while entries operations are in flight
+		/// @param offset File offset, -1 for current file position or end of O_APPEND file
+		void write(Operation* operation, int descriptor, const void* buffer, uint32_t size, uint64_t offset);
+
+		/// @brief Wait for operations in flight and stop completion thread
+		~IoRing();
+	};
+}
+#endif
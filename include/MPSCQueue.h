@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <concepts>
+
+namespace file_manager::_utility
+{
+	/// @brief Base class for elements of MPSCQueue
+	struct MPSCQueueNode
+	{
+		std::atomic<MPSCQueueNode*> next = nullptr;
+	};
+
+	/**
+	 * @brief Intrusive multiple producers single consumer queue
+	 * Push is wait-free. Pop must not be called from different threads at the same time
+	 */
+	template<std::derived_from<MPSCQueueNode> T>
+	class MPSCQueue
+	{
+	private:
+		alignas(64) std::atomic<MPSCQueueNode*> tail;
+		alignas(64) MPSCQueueNode* head;
+		MPSCQueueNode stub;
+
+	private:
+		void pushNode(MPSCQueueNode* node);
+
+	public:
+		MPSCQueue();
+
+		MPSCQueue(const MPSCQueue&) = delete;
+
+		MPSCQueue& operator = (const MPSCQueue&) = delete;
+
+		/**
+		 * @brief Add element to queue
+		 * @param value Element. Queue does not own it
+		 */
+		void push(T* value);
+
+		/**
+		 * @brief Give out first element from queue
+		 * @return First element or nullptr if queue is empty or producer has not finished linking it yet
+		 */
+		T* pop();
+
+		~MPSCQueue() = default;
+	};
+
+	template<std::derived_from<MPSCQueueNode> T>
+	void MPSCQueue<T>::pushNode(MPSCQueueNode* node)
+	{
+		node->next.store(nullptr, std::memory_order_relaxed);
+
+		MPSCQueueNode* previous = tail.exchange(node, std::memory_order_acq_rel);
+
+		previous->next.store(node, std::memory_order_release);
+	}
+
+	template<std::derived_from<MPSCQueueNode> T>
+	MPSCQueue<T>::MPSCQueue() :
+		tail(&stub),
+		head(&stub)
+	{
+
+	}
+
+	template<std::derived_from<MPSCQueueNode> T>
+	void MPSCQueue<T>::push(T* value)
+	{
+		this->pushNode(value);
+	}
+
+	template<std::derived_from<MPSCQueueNode> T>
+	T* MPSCQueue<T>::pop()
+	{
+		MPSCQueueNode* first = head;
+		MPSCQueueNode* next = first->next.load(std::memory_order_acquire);
+
+		if (first == &stub)
+		{
+			if (!next)
+			{
+				return nullptr;
+			}
+
+			head = next;
+			first = next;
+			next = next->next.load(std::memory_order_acquire);
+		}
+
+		if (next)
+		{
+			head = next;
+
+			return static_cast<T*>(first);
+		}
+
+		if (first != tail.load(std::memory_order_acquire))
+		{
+			return nullptr;
+		}
+
+		this->pushNode(&stub);
+
+		next = first->next.load(std::memory_order_acquire);
+
+		if (next)
+		{
+			head = next;
+
+			return static_cast<T*>(first);
+		}
+
+		return nullptr;
+	}
+}
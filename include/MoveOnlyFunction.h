@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <type_traits>
+#include <functional>
+
+#include "RequestArena.h"
+
+namespace file_manager::_utility
+{
+	template<typename SignatureT, size_t BufferSize = 96>
+	class MoveOnlyFunction;
+
+	/**
+	 * @brief Move only type erased callable
+	 * Callables up to BufferSize bytes with nothrow move constructor are stored inline, bigger ones are allocated in RequestArena
+	 */
+	template<typename R, typename... Args, size_t BufferSize>
+	class MoveOnlyFunction<R(Args...), BufferSize>
+	{
+	private:
+		struct Operations
+		{
+			R(*invoke)(void* storage, Args&&... args);
+			void(*move)(void* from, void* to) noexcept;
+			void(*destroy)(void* storage) noexcept;
+		};
+
+	private:
+		template<typename T>
+		static constexpr bool isInline = sizeof(T) <= BufferSize && alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<T>;
+
+		template<typename T>
+		static T& get(void* storage);
+
+		template<typename T>
+		static constexpr Operations operations =
+		{
+			[](void* storage, Args&&... args) -> R
+			{
+				return std::invoke(MoveOnlyFunction::get<T>(storage), std::forward<Args>(args)...);
+			},
+			[](void* from, void* to) noexcept
+			{
+				if constexpr (isInline<T>)
+				{
+					new (to) T(std::move(*static_cast<T*>(from)));
+
+					static_cast<T*>(from)->~T();
+				}
+				else
+				{
+					*static_cast<T**>(to) = *static_cast<T**>(from);
+				}
+			},
+			[](void* storage) noexcept
+			{
+				if constexpr (isInline<T>)
+				{
+					static_cast<T*>(storage)->~T();
+				}
+				else
+				{
+					T* callable = *static_cast<T**>(storage);
+
+					callable->~T();
+
+					RequestArena::deallocate(callable);
+				}
+			}
+		};
+
+	private:
+		alignas(std::max_align_t) std::byte buffer[BufferSize];
+		const Operations* implementation;
+
+	public:
+		MoveOnlyFunction() noexcept;
+
+		template<typename T> requires (!std::is_same_v<std::remove_cvref_t<T>, MoveOnlyFunction> && std::is_invocable_r_v<R, std::decay_t<T>&, Args...>)
+		MoveOnlyFunction(T&& callable);
+
+		MoveOnlyFunction(const MoveOnlyFunction&) = delete;
+
+		MoveOnlyFunction(MoveOnlyFunction&& other) noexcept;
+
+		MoveOnlyFunction& operator = (const MoveOnlyFunction&) = delete;
+
+		MoveOnlyFunction& operator = (MoveOnlyFunction&& other) noexcept;
+
+		R operator () (Args... args);
+
+		explicit operator bool() const noexcept;
+
+		~MoveOnlyFunction();
+	};
+
+	template<typename R, typename... Args, size_t BufferSize>
+	template<typename T>
+	T& MoveOnlyFunction<R(Args...), BufferSize>::get(void* storage)
+	{
+		if constexpr (isInline<T>)
+		{
+			return *static_cast<T*>(storage);
+		}
+		else
+		{
+			return **static_cast<T**>(storage);
+		}
+	}
+
+	template<typename R, typename... Args, size_t BufferSize>
+	MoveOnlyFunction<R(Args...), BufferSize>::MoveOnlyFunction() noexcept :
+		implementation(nullptr)
+	{
+
+	}
+
+	template<typename R, typename... Args, size_t BufferSize>
+	template<typename T> requires (!std::is_same_v<std::remove_cvref_t<T>, MoveOnlyFunction<R(Args...), BufferSize>> && std::is_invocable_r_v<R, std::decay_t<T>&, Args...>)
+	MoveOnlyFunction<R(Args...), BufferSize>::MoveOnlyFunction(T&& callable) :
+		implementation(&operations<std::decay_t<T>>)
+	{
+		using CallableT = std::decay_t<T>;
+
+		if constexpr (isInline<CallableT>)
+		{
+			new (buffer) CallableT(std::forward<T>(callable));
+		}
+		else
+		{
+			void* storage = RequestArena::allocate(sizeof(CallableT));
+
+			try
+			{
+				*reinterpret_cast<CallableT**>(buffer) = new (storage) CallableT(std::forward<T>(callable));
+			}
+			catch (...)
+			{
+				RequestArena::deallocate(storage);
+
+				throw;
+			}
+		}
+	}
+
+	template<typename R, typename... Args, size_t BufferSize>
+	MoveOnlyFunction<R(Args...), BufferSize>::MoveOnlyFunction(MoveOnlyFunction&& other) noexcept :
+		implementation(std::exchange(other.implementation, nullptr))
+	{
+		if (implementation)
+		{
+			implementation->move(other.buffer, buffer);
+		}
+	}
+
+	template<typename R, typename... Args, size_t BufferSize>
+	MoveOnlyFunction<R(Args...), BufferSize>& MoveOnlyFunction<R(Args...), BufferSize>::operator = (MoveOnlyFunction&& other) noexcept
+	{
+		if (this != &other)
+		{
+			if (implementation)
+			{
+				implementation->destroy(buffer);
+			}
+
+			implementation = std::exchange(other.implementation, nullptr);
+
+			if (implementation)
+			{
+				implementation->move(other.buffer, buffer);
+			}
+		}
+
+		return *this;
+	}
+
+	template<typename R, typename... Args, size_t BufferSize>
+	R MoveOnlyFunction<R(Args...), BufferSize>::operator () (Args... args)
+	{
+		if (!implementation)
+		{
+			throw std::bad_function_call();
+		}
+
+		return implementation->invoke(buffer, std::forward<Args>(args)...);
+	}
+
+	template<typename R, typename... Args, size_t BufferSize>
+	MoveOnlyFunction<R(Args...), BufferSize>::operator bool() const noexcept
+	{
+		return implementation != nullptr;
+	}
+
+	template<typename R, typename... Args, size_t BufferSize>
+	MoveOnlyFunction<R(Args...), BufferSize>::~MoveOnlyFunction()
+	{
+		if (implementation)
+		{
+			implementation->destroy(buffer);
+		}
+	}
+}
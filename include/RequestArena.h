@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+#include "Utility.h"
+
+namespace file_manager::_utility
+{
+	/**
+	 * @brief Thread caching pool of small blocks for request objects, callbacks and completion states
+	 * Each thread allocates from its own arena without synchronization. Blocks freed by other threads are returned to owning arena through lock-free list
+	 * Arenas of finished threads are reused by new threads, so memory is bounded by peak usage
+	 */
+	class FILE_MANAGER_API RequestArena
+	{
+	public:
+		/// @brief Biggest block served from arena. Bigger blocks are allocated with global operator new
+		static constexpr size_t maxBlockSize = 512;
+
+	public:
+		/**
+		 * @brief Allocate block
+		 * @param size Size in bytes
+		 * @return Block aligned to alignof(std::max_align_t)
+		 */
+		static void* allocate(size_t size);
+
+		/**
+		 * @brief Return block to its arena. Can be called from any thread
+		 * @param block Block from allocate
+		 */
+		static void deallocate(void* block) noexcept;
+	};
+
+	/// @brief Allocator that takes memory from RequestArena
+	template<typename T>
+	class RequestAllocator
+	{
+	public:
+		using value_type = T;
+
+	public:
+		RequestAllocator() noexcept = default;
+
+		template<typename U>
+		RequestAllocator(const RequestAllocator<U>&) noexcept;
+
+		T* allocate(size_t count);
+
+		void deallocate(T* data, size_t count) noexcept;
+
+		template<typename U>
+		bool operator == (const RequestAllocator<U>&) const noexcept;
+	};
+
+	template<typename T>
+	template<typename U>
+	RequestAllocator<T>::RequestAllocator(const RequestAllocator<U>&) noexcept
+	{
+
+	}
+
+	template<typename T>
+	T* RequestAllocator<T>::allocate(size_t count)
+	{
+		static_assert(alignof(T) <= alignof(std::max_align_t), "Over-aligned types are not supported");
+
+		return static_cast<T*>(RequestArena::allocate(count * sizeof(T)));
+	}
+
+	template<typename T>
+	void RequestAllocator<T>::deallocate(T* data, size_t) noexcept
+	{
+		RequestArena::deallocate(data);
+	}
+
+	template<typename T>
+	template<typename U>
+	bool RequestAllocator<T>::operator == (const RequestAllocator<U>&) const noexcept
+	{
+		return true;
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <filesystem>
+#include <istream>
 #include <cmath>
 
 #ifdef __LINUX__
@@ -58,8 +59,24 @@ namespace file_manager
 			{ OperationT()(left, right) } -> std::convertible_to<uint64_t>;
 		};
 
+		/// @brief Put data written through WriteFileHandle to cache. Its size must be already reserved with changeCurrentCacheSize
 		void addCache(std::filesystem::path&& filePath, std::string&& data);
 
+		/**
+		 * @brief Read stream from current position to the end
+		 * Remaining size is taken from stream positions, so data is read with one sized read straight into outData instead of growing intermediate buffer
+		 * Falls back to copying through std::ostringstream for streams without known size
+		 * @param stream Input stream
+		 * @param outData Stream data
+		 */
+		void readAll(std::istream& stream, std::string& outData);
+
+		/// @brief Flush file on path to storage with fdatasync or fsync. Directory can be synced on Linux
+		/// @param filePath Path to file
+		/// @param isFull If true metadata is flushed too
+		/// @exception std::system_error
+		void syncFile(const std::filesystem::path& filePath, bool isFull);
+
 		template<template<typename> typename OperationT> requires _utility::Operation<OperationT<uint64_t>>
 		void changeCurrentCacheSize(uint64_t amount);
 	}
@@ -0,0 +1,120 @@
+#include "AlignedBufferPool.h"
+
+#include <mutex>
+#include <vector>
+#include <new>
+#include <cstdint>
+#include <utility>
+
+namespace
+{
+	struct FreeBuffers
+	{
+		std::vector<std::byte*> data;
+		std::mutex dataMutex;
+
+		FreeBuffers()
+		{
+			// Returning buffer never allocates
+			data.reserve(file_manager::_utility::AlignedBufferPool::maxFreeBuffers);
+		}
+
+		~FreeBuffers()
+		{
+			for (std::byte* buffer : data)
+			{
+				::operator delete(buffer, std::align_val_t(file_manager::_utility::AlignedBufferPool::alignment));
+			}
+		}
+	};
+
+	FreeBuffers& getFreeBuffers()
+	{
+		static FreeBuffers freeBuffers;
+
+		return freeBuffers;
+	}
+}
+
+namespace file_manager::_utility
+{
+	AlignedBufferPool::Buffer::Buffer() :
+		data(AlignedBufferPool::allocate())
+	{
+
+	}
+
+	AlignedBufferPool::Buffer::Buffer(Buffer&& other) noexcept :
+		data(std::exchange(other.data, nullptr))
+	{
+
+	}
+
+	AlignedBufferPool::Buffer& AlignedBufferPool::Buffer::operator = (Buffer&& other) noexcept
+	{
+		if (this != &other)
+		{
+			AlignedBufferPool::deallocate(std::exchange(data, std::exchange(other.data, nullptr)));
+		}
+
+		return *this;
+	}
+
+	std::span<std::byte> AlignedBufferPool::Buffer::get() const
+	{
+		return std::span<std::byte>(data, bufferSize);
+	}
+
+	AlignedBufferPool::Buffer::~Buffer()
+	{
+		AlignedBufferPool::deallocate(data);
+	}
+
+	std::byte* AlignedBufferPool::allocate()
+	{
+		FreeBuffers& freeBuffers = getFreeBuffers();
+
+		{
+			std::unique_lock<std::mutex> lock(freeBuffers.dataMutex);
+
+			if (freeBuffers.data.size())
+			{
+				std::byte* result = freeBuffers.data.back();
+
+				freeBuffers.data.pop_back();
+
+				return result;
+			}
+		}
+
+		return static_cast<std::byte*>(::operator new(bufferSize, std::align_val_t(alignment)));
+	}
+
+	void AlignedBufferPool::deallocate(std::byte* data) noexcept
+	{
+		if (!data)
+		{
+			return;
+		}
+
+		FreeBuffers& freeBuffers = getFreeBuffers();
+
+		{
+			std::unique_lock<std::mutex> lock(freeBuffers.dataMutex);
+
+			if (freeBuffers.data.size() < maxFreeBuffers)
+			{
+				freeBuffers.data.push_back(data);
+
+				return;
+			}
+		}
+
+		::operator delete(data, std::align_val_t(alignment));
+	}
+
+	bool AlignedBufferPool::isAligned(const void* data)
+	{
+		return !(reinterpret_cast<uintptr_t>(data) & (alignment - 1));
+	}
+}
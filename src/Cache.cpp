@@ -3,178 +3,411 @@
 #include "FileManager.h"
 #include "Exceptions/FileDoesNotExistException.h"
 
-namespace std
+namespace file_manager
 {
-	template<>
-	struct less<pair<uint64_t, filesystem::path>>
+	std::list<Cache::Entry>& Cache::getSegment(Segment segment) const
 	{
-		constexpr bool operator()(const pair<uint64_t, filesystem::path>& left, const pair<uint64_t, filesystem::path>& right) const
-		{
-			return left.first > right.first;
-		}
-	};
-}
+		return segments[static_cast<size_t>(segment)];
+	}
 
-namespace file_manager
-{
-	void Cache::updateCache()
+	uint64_t& Cache::getSegmentSize(Segment segment) const
+	{
+		return segmentSizes[static_cast<size_t>(segment)];
+	}
+
+	void Cache::move(std::list<Entry>::iterator entry, Segment segment) const
 	{
-		std::priority_queue<std::pair<uint64_t, std::filesystem::path>> paths;
-		std::vector<std::pair<uint64_t, const std::filesystem::path*>> notExistingPaths;
-		std::lock_guard<std::mutex> cacheDataLock(cacheDataMutex);
+		std::list<Entry>& to = this->getSegment(segment);
 
-		for (const auto& [path, _] : cacheData)
+		if (entry->segment != segment)
 		{
-			uint64_t size = std::filesystem::file_size(path);
+			this->getSegmentSize(entry->segment) -= entry->data->size();
+			this->getSegmentSize(segment) += entry->data->size();
+		}
 
-			if (!std::filesystem::exists(path))
-			{
-				notExistingPaths.emplace_back(size, &path);
+		// Splice keeps iterators in index valid
+		to.splice(to.begin(), this->getSegment(entry->segment), entry);
 
-				continue;
-			}
+		entry->segment = segment;
+	}
 
-			paths.emplace(size, path);
-		}
+	void Cache::touch(std::list<Entry>::iterator entry) const
+	{
+		sketch.increment(entry->hash);
 
-		for (const auto& [size, path] : notExistingPaths)
+		if (entry->segment != Segment::probation)
 		{
-			currentCacheSize -= size;
+			this->move(entry, entry->segment);
 
-			cacheData.erase(*path);
+			return;
 		}
 
-		while (currentCacheSize < cacheSize && paths.size())
+		std::list<Entry>& frequent = this->getSegment(Segment::frequent);
+		uint64_t frequentCapacity = (cacheSize - cacheSize * windowPercent / 100) * frequentPercent / 100;
+
+		this->move(entry, Segment::frequent);
+
+		while (this->getSegmentSize(Segment::frequent) > frequentCapacity && frequent.size())
 		{
-			const auto& [size, path] = paths.top();
+			this->move(std::prev(frequent.end()), Segment::probation);
+		}
+	}
 
-			currentCacheSize -= size;
+	bool Cache::insert(const std::filesystem::path& filePath, std::shared_ptr<std::string>&& data)
+	{
+		std::list<Entry>& window = this->getSegment(Segment::window);
+		size_t hash = utility::PathHash()(filePath);
 
-			cacheData.erase(path);
+		sketch.increment(hash);
 
-			paths.pop();
-		}
+		this->getSegmentSize(Segment::window) += data->size();
+
+		window.emplace_front(filePath, std::move(data), hash, Segment::window);
+
+		index.try_emplace(filePath, window.begin());
+
+		sketch.ensureCapacity(index.size());
+
+		this->updateCache();
+
+		return index.contains(filePath);
 	}
 
-	Cache& Cache::getCache()
+	void Cache::remove(std::list<Entry>::iterator entry)
 	{
-		return FileManager::getInstance().getCache();
+		this->getSegmentSize(entry->segment) -= entry->data->size();
+
+		currentCacheSize -= entry->data->size();
+
+		index.erase(entry->filePath);
+
+		this->getSegment(entry->segment).erase(entry);
 	}
 
-	Cache::Cache() :
-		cacheSize(0),
-		currentCacheSize(0)
+	void Cache::admit(std::list<Entry>::iterator candidate)
+	{
+		uint64_t mainCapacity = cacheSize - cacheSize * windowPercent / 100;
+		uint64_t size = candidate->data->size();
+		uint32_t candidateFrequency = sketch.frequency(candidate->hash);
+		std::list<Entry>& probation = this->getSegment(Segment::probation);
+		std::list<Entry>& frequent = this->getSegment(Segment::frequent);
+
+		while (this->getSegmentSize(Segment::probation) + this->getSegmentSize(Segment::frequent) + size > mainCapacity)
+		{
+			std::list<Entry>& victims = probation.size() ? probation : frequent;
+
+			// Victim is kept on tie, so one-time accesses can't flush main space
+			if (victims.empty() || sketch.frequency(victims.back().hash) >= candidateFrequency)
+			{
+				this->remove(candidate);
+
+				return;
+			}
+
+			this->remove(std::prev(victims.end()));
+		}
+
+		this->move(candidate, Segment::probation);
+	}
+
+	void Cache::updateCache()
 	{
+		std::list<Entry>& window = this->getSegment(Segment::window);
+		uint64_t windowCapacity = policy == EvictionPolicy::lru ? cacheSize : cacheSize * windowPercent / 100;
 
+		while (this->getSegmentSize(Segment::window) > windowCapacity && window.size())
+		{
+			this->admit(std::prev(window.end()));
+		}
+
+		// Reserved size of writers is not part of segments, so entries can still exceed cache size
+		while (currentCacheSize > cacheSize && index.size())
+		{
+			for (Segment segment : { Segment::probation, Segment::window, Segment::frequent })
+			{
+				if (std::list<Entry>& victims = this->getSegment(segment); victims.size())
+				{
+					this->remove(std::prev(victims.end()));
+
+					break;
+				}
+			}
+		}
 	}
 
-	Cache::CacheResultCodes Cache::addCache(const std::filesystem::path& filePath, std::ios_base::openmode mode)
+	Cache::CacheResultCodes Cache::load(const std::filesystem::path& filePath, const std::function<std::istream*()>& open, std::shared_ptr<const std::string>& outData)
 	{
-		if (!std::filesystem::exists(filePath))
+		uint64_t version;
+
+		{
+			std::lock_guard<std::mutex> dataLock(cacheDataMutex);
+
+			if (auto it = index.find(filePath); it != index.end())
+			{
+				this->touch(it->second);
+
+				outData = it->second->data;
+
+				return CacheResultCodes::noError;
+			}
+
+			version = invalidations;
+		}
+
+		std::error_code error;
+		uint64_t fileSize = std::filesystem::file_size(filePath, error);
+
+		if (error)
 		{
 			return CacheResultCodes::fileDoesNotExist;
 		}
-		else if (currentCacheSize + std::filesystem::file_size(filePath) > cacheSize)
+		else if (fileSize > cacheSize)
 		{
 			return CacheResultCodes::notEnoughCacheSize;
 		}
 
+		std::istream* file = open();
+
+		if (!file)
+		{
+			return CacheResultCodes::fileDoesNotExist;
+		}
+
+		std::shared_ptr<std::string> data = std::make_shared<std::string>();
+
+		_utility::readAll(*file, *data);
+
+		outData = data;
+
 		std::lock_guard<std::mutex> dataLock(cacheDataMutex);
 
-		if (cacheData.contains(filePath))
+		if (auto it = index.find(filePath); it != index.end())
 		{
+			this->touch(it->second);
+
+			outData = it->second->data;
+
 			return CacheResultCodes::noError;
 		}
+		else if (version != invalidations || data->size() > cacheSize)
+		{
+			return CacheResultCodes::notEnoughCacheSize;
+		}
 
-		std::string data = (std::ostringstream() << std::ifstream(filePath, mode).rdbuf()).str();
+		currentCacheSize += data->size();
 
-		currentCacheSize += data.size();
+		return this->insert(filePath, std::move(data)) ? CacheResultCodes::noError : CacheResultCodes::notEnoughCacheSize;
+	}
+
+	Cache& Cache::getCache()
+	{
+		return FileManager::getInstance().getCache();
+	}
+
+	Cache::Cache() :
+		segmentSizes{},
+		policy(EvictionPolicy::windowTinyLfu),
+		cacheSize(0),
+		invalidations(0),
+		currentCacheSize(0),
+		reservedCacheSize(0)
+	{
+
+	}
+
+	Cache::CacheResultCodes Cache::addCache(const std::filesystem::path& filePath, std::ios_base::openmode mode)
+	{
+		std::shared_ptr<const std::string> data;
+
+		return this->addCache(filePath, mode, data);
+	}
+
+	Cache::CacheResultCodes Cache::addCache(const std::filesystem::path& filePath, std::ios_base::openmode mode, std::shared_ptr<const std::string>& outData)
+	{
+		std::ifstream file;
+
+		return this->load
+		(
+			filePath,
+			[&]() -> std::istream*
+			{
+				file.open(filePath, mode);
 
-		cacheData.try_emplace(filePath, move(data));
+				return file.is_open() ? &file : nullptr;
+			},
+			outData
+		);
+	}
 
-		return CacheResultCodes::noError;
+	Cache::CacheResultCodes Cache::addCache(const std::filesystem::path& filePath, std::istream& stream, std::shared_ptr<const std::string>& outData)
+	{
+		return this->load
+		(
+			filePath,
+			[&stream]() -> std::istream*
+			{
+				return stream ? &stream : nullptr;
+			},
+			outData
+		);
 	}
 
 	Cache::CacheResultCodes Cache::appendCache(const std::filesystem::path& filePath, const std::vector<char>& data)
 	{
-		return this->appendCache(filePath, data.data());
+		return this->appendCache(filePath, std::string_view(data.data(), data.size()));
 	}
 
 	Cache::CacheResultCodes Cache::appendCache(const std::filesystem::path& filePath, std::string_view data)
 	{
-		if (currentCacheSize + data.size() > cacheSize)
+		std::lock_guard<std::mutex> dataLock(cacheDataMutex);
+		auto it = index.find(filePath);
+
+		if (it == index.end())
 		{
-			return CacheResultCodes::notEnoughCacheSize;
+			if (data.size() > cacheSize)
+			{
+				return CacheResultCodes::notEnoughCacheSize;
+			}
+
+			currentCacheSize += data.size();
+
+			return this->insert(filePath, std::make_shared<std::string>(data)) ? CacheResultCodes::noError : CacheResultCodes::notEnoughCacheSize;
 		}
 
-		std::lock_guard<std::mutex> dataLock(cacheDataMutex);
+		Entry& entry = *it->second;
 
-		if (auto it = cacheData.find(filePath); it != cacheData.end())
+		if (entry.data->size() + data.size() > cacheSize)
 		{
-			it->second += data;
+			return CacheResultCodes::notEnoughCacheSize;
 		}
-		else
+
+		// Readers may still use current data
+		if (entry.data.use_count() > 1)
 		{
-			cacheData[filePath] = data;
+			entry.data = std::make_shared<std::string>(*entry.data);
 		}
 
+		*entry.data += data;
+
+		this->getSegmentSize(entry.segment) += data.size();
+
 		currentCacheSize += data.size();
 
-		return CacheResultCodes::noError;
+		this->touch(it->second);
+
+		this->updateCache();
+
+		return index.contains(filePath) ? CacheResultCodes::noError : CacheResultCodes::notEnoughCacheSize;
 	}
 
 	bool Cache::contains(const std::filesystem::path& filePath) const
 	{
 		std::lock_guard<std::mutex> dataLock(cacheDataMutex);
 
-		return cacheData.contains(filePath);
+		return index.contains(filePath);
 	}
 
 	void Cache::clear()
 	{
 		std::lock_guard<std::mutex> dataLock(cacheDataMutex);
-		
-		currentCacheSize = 0;
 
-		cacheData.clear();
+		for (uint64_t& size : segmentSizes)
+		{
+			currentCacheSize -= size;
+
+			size = 0;
+		}
+
+		for (std::list<Entry>& segment : segments)
+		{
+			segment.clear();
+		}
+
+		index.clear();
+
+		invalidations++;
 	}
 
 	void Cache::clear(const std::filesystem::path& filePath)
 	{
 		std::lock_guard<std::mutex> dataLock(cacheDataMutex);
-		auto it = cacheData.find(filePath);
 
-		if (it == cacheData.end())
+		invalidations++;
+
+		if (auto it = index.find(filePath); it != index.end())
 		{
-			return;
+			this->remove(it->second);
 		}
-
-		currentCacheSize -= it->second.size();
-
-		cacheData.erase(it);
 	}
 
 	void Cache::setCacheSize(uint64_t sizeInBytes)
 	{
+		std::lock_guard<std::mutex> dataLock(cacheDataMutex);
+
 		cacheSize = sizeInBytes;
 
-		if (cacheSize < currentCacheSize)
+		this->updateCache();
+	}
+
+	void Cache::setEvictionPolicy(EvictionPolicy policy)
+	{
+		std::lock_guard<std::mutex> dataLock(cacheDataMutex);
+
+		this->policy = policy;
+
+		if (policy == EvictionPolicy::lru)
 		{
-			this->updateCache();
+			std::list<Entry>& window = this->getSegment(Segment::window);
+
+			// Main space entries become older than window entries
+			for (Segment segment : { Segment::frequent, Segment::probation })
+			{
+				for (Entry& entry : this->getSegment(segment))
+				{
+					entry.segment = Segment::window;
+				}
+
+				this->getSegmentSize(Segment::window) += this->getSegmentSize(segment);
+				this->getSegmentSize(segment) = 0;
+
+				window.splice(window.end(), this->getSegment(segment));
+			}
 		}
+
+		this->updateCache();
 	}
 
-	const std::string& Cache::getCacheData(const std::filesystem::path& filePath) const
+	std::shared_ptr<const std::string> Cache::getCacheData(const std::filesystem::path& filePath) const
 	{
 		std::lock_guard<std::mutex> dataLock(cacheDataMutex);
-		auto it = cacheData.find(filePath);
+		auto it = index.find(filePath);
 
-		if (it == cacheData.end())
+		if (it == index.end())
 		{
 			throw exceptions::FileDoesNotExistException(filePath);
 		}
 
-		return it->second;
+		this->touch(it->second);
+
+		return it->second->data;
+	}
+
+	std::shared_ptr<const std::string> Cache::shareCacheData(const std::filesystem::path& filePath) const
+	{
+		std::lock_guard<std::mutex> dataLock(cacheDataMutex);
+		auto it = index.find(filePath);
+
+		if (it == index.end())
+		{
+			// Misses count too, so frequently requested file can win admission
+			sketch.increment(utility::PathHash()(filePath));
+
+			return nullptr;
+		}
+
+		this->touch(it->second);
+
+		return it->second->data;
 	}
 
 	uint64_t Cache::getCacheSize() const
@@ -187,7 +420,17 @@ namespace file_manager
 		return currentCacheSize;
 	}
 
-	const std::string& Cache::operator [] (const std::filesystem::path& filePath) const
+	uint64_t Cache::getReservedCacheSize() const
+	{
+		return reservedCacheSize;
+	}
+
+	Cache::EvictionPolicy Cache::getEvictionPolicy() const
+	{
+		return policy;
+	}
+
+	std::shared_ptr<const std::string> Cache::operator [] (const std::filesystem::path& filePath) const
 	{
 		return this->getCacheData(filePath);
 	}
@@ -0,0 +1,157 @@
+#include "CompletionQueue.h"
+
+#include <algorithm>
+#include <system_error>
+
+#ifdef __LINUX__
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include "Exceptions/FileDoesNotExistException.h"
+#include "Exceptions/NotAFileException.h"
+
+namespace file_manager
+{
+	void CompletionQueue::post(const Completion& completion)
+	{
+		{
+			std::lock_guard<std::mutex> lock(completionsMutex);
+
+#ifdef __LINUX__
+			// Signal only empty to non empty transition, harvest resets eventfd when queue becomes empty
+			if (eventDescriptor != -1 && head == completions.size())
+			{
+				eventfd_write(eventDescriptor, 1);
+			}
+#endif
+
+			completions.push_back(completion);
+
+			if (!waiters)
+			{
+				return;
+			}
+		}
+
+		hasCompletions.notify_all();
+	}
+
+	size_t CompletionQueue::harvest(std::span<Completion> outCompletions)
+	{
+		size_t result = std::min(outCompletions.size(), completions.size() - head);
+
+		std::copy_n(completions.begin() + head, result, outCompletions.begin());
+
+		head += result;
+
+		if (head == completions.size())
+		{
+			completions.clear();
+
+			head = 0;
+
+#ifdef __LINUX__
+			if (eventDescriptor != -1 && result)
+			{
+				eventfd_t value;
+
+				eventfd_read(eventDescriptor, &value);
+			}
+#endif
+		}
+
+		return result;
+	}
+
+	CompletionQueue::Status CompletionQueue::getStatus(const std::exception_ptr& exception)
+	{
+		try
+		{
+			std::rethrow_exception(exception);
+		}
+		catch (const exceptions::FileDoesNotExistException&)
+		{
+			return Status::fileDoesNotExist;
+		}
+		catch (const exceptions::NotAFileException&)
+		{
+			return Status::notAFile;
+		}
+		catch (...)
+		{
+			return Status::failed;
+		}
+	}
+
+	CompletionQueue::CompletionQueue() :
+		head(0),
+		waiters(0)
+#ifdef __LINUX__
+		, eventDescriptor(-1)
+#endif
+	{
+
+	}
+
+	size_t CompletionQueue::poll(std::span<Completion> outCompletions)
+	{
+		std::lock_guard<std::mutex> lock(completionsMutex);
+
+		return this->harvest(outCompletions);
+	}
+
+	size_t CompletionQueue::wait(std::span<Completion> outCompletions)
+	{
+		std::unique_lock<std::mutex> lock(completionsMutex);
+
+		waiters++;
+
+		hasCompletions.wait(lock, [this]() { return head != completions.size(); });
+
+		waiters--;
+
+		return this->harvest(outCompletions);
+	}
+
+	size_t CompletionQueue::size() const
+	{
+		std::lock_guard<std::mutex> lock(completionsMutex);
+
+		return completions.size() - head;
+	}
+
+#ifdef __LINUX__
+	int CompletionQueue::getEventDescriptor()
+	{
+		std::lock_guard<std::mutex> lock(completionsMutex);
+
+		if (eventDescriptor == -1)
+		{
+			eventDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+			if (eventDescriptor == -1)
+			{
+				throw std::system_error(errno, std::generic_category(), "eventfd");
+			}
+
+			if (head != completions.size())
+			{
+				eventfd_write(eventDescriptor, 1);
+			}
+		}
+
+		return eventDescriptor;
+	}
+#endif
+
+	CompletionQueue::~CompletionQueue()
+	{
+#ifdef __LINUX__
+		if (eventDescriptor != -1)
+		{
+			close(eventDescriptor);
+		}
+#endif
+	}
+}
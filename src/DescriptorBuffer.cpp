@@ -0,0 +1,531 @@
+#include "DescriptorBuffer.h"
+
+#ifdef __LINUX__
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+#include <climits>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "FileManager.h"
+
+namespace file_manager::_utility
+{
+	uint64_t DescriptorBuffer::getPosition() const
+	{
+		return (mode & std::ios_base::in) ?
+			bufferOffset + static_cast<uint64_t>(gptr() - eback()) :
+			bufferOffset + static_cast<uint64_t>(pptr() - pbase());
+	}
+
+	void DescriptorBuffer::initialize(std::ios_base::openmode mode)
+	{
+		this->mode = mode;
+
+		bufferOffset = 0;
+
+		if (mode & std::ios_base::in)
+		{
+			ownedBuffer.reset(new char[inputBufferSize]);
+
+			bufferData = ownedBuffer.get();
+			bufferSize = inputBufferSize;
+
+			setg(bufferData, bufferData, bufferData);
+
+			return;
+		}
+
+		if (!bufferData)
+		{
+			ownedBuffer.reset(new char[outputBufferSize]);
+
+			bufferData = ownedBuffer.get();
+			bufferSize = outputBufferSize;
+		}
+
+		setp(bufferData, bufferData + bufferSize);
+	}
+
+	bool DescriptorBuffer::writeBuffer(std::span<const std::string_view> data)
+	{
+		constexpr size_t inlineParts = 8;
+		iovec inlined[inlineParts];
+		std::unique_ptr<iovec[]> allocated;
+		size_t count = data.size() + 1;
+		iovec* current = count <= inlineParts ? inlined : (allocated = std::make_unique<iovec[]>(count)).get();
+		size_t remaining = static_cast<size_t>(pptr() - pbase());
+		uint64_t offset = bufferOffset;
+
+		current[0] = { pbase(), remaining };
+
+		for (size_t i = 0; i < data.size(); i++)
+		{
+			current[i + 1] = { const_cast<char*>(data[i].data()), data[i].size() };
+
+			remaining += data[i].size();
+		}
+
+		while (remaining)
+		{
+			// Offset is ignored for O_APPEND descriptor, data goes to the end of file
+			ssize_t written = pwritev(descriptor, current, static_cast<int>(std::min<size_t>(count, IOV_MAX)), static_cast<off_t>(offset));
+
+			if (written == -1)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				return false;
+			}
+
+			size_t skipped = static_cast<size_t>(written);
+
+			remaining -= skipped;
+			offset += skipped;
+
+			while (count && skipped >= current->iov_len)
+			{
+				skipped -= current->iov_len;
+
+				current++;
+				count--;
+			}
+
+			if (count)
+			{
+				current->iov_base = static_cast<char*>(current->iov_base) + skipped;
+				current->iov_len -= skipped;
+			}
+		}
+
+		bufferOffset = offset;
+
+		setp(bufferData, bufferData + bufferSize);
+
+		return true;
+	}
+
+	bool DescriptorBuffer::writeBuffer(std::string_view data)
+	{
+		return this->writeBuffer(std::span<const std::string_view>(&data, 1));
+	}
+
+	DescriptorBuffer::pos_type DescriptorBuffer::seek(off_type offset, int whence, std::ios_base::openmode which)
+	{
+		const pos_type failed = pos_type(off_type(-1));
+		bool isInput = mode & std::ios_base::in;
+		bool isAppend = !isInput && access == DescriptorCache::Access::append;
+
+		if (descriptor == -1 || !(which & (isInput ? std::ios_base::in : std::ios_base::out)))
+		{
+			return failed;
+		}
+
+		// Position query doesn't flush
+		if (whence == SEEK_CUR && !offset && !isAppend)
+		{
+			return pos_type(static_cast<off_type>(this->getPosition()));
+		}
+
+		// Pending data is written through overflow, so derived buffers see it
+		if (!isInput && traits_type::eq_int_type(this->overflow(traits_type::eof()), traits_type::eof()))
+		{
+			return failed;
+		}
+
+		off_type base = 0;
+
+		if (whence == SEEK_END || (whence == SEEK_CUR && isAppend))
+		{
+			struct stat status;
+
+			if (fstat(descriptor, &status))
+			{
+				return failed;
+			}
+
+			base = static_cast<off_type>(status.st_size);
+		}
+		else if (whence == SEEK_CUR)
+		{
+			base = static_cast<off_type>(this->getPosition());
+		}
+
+		off_type target = base + offset;
+
+		if (target < 0)
+		{
+			return failed;
+		}
+
+		uint64_t position = static_cast<uint64_t>(target);
+
+		// Seek inside get area keeps buffered data
+		if (isInput && position >= bufferOffset && position <= bufferOffset + static_cast<uint64_t>(egptr() - eback()))
+		{
+			setg(eback(), eback() + (position - bufferOffset), egptr());
+		}
+		else
+		{
+			bufferOffset = position;
+
+			if (isInput)
+			{
+				setg(bufferData, bufferData, bufferData);
+			}
+		}
+
+		return pos_type(target);
+	}
+
+	std::streambuf* DescriptorBuffer::setbuf(char* data, std::streamsize size)
+	{
+		if (descriptor == -1 && data && size > 0)
+		{
+			bufferData = data;
+			bufferSize = static_cast<size_t>(size);
+		}
+
+		return this;
+	}
+
+	DescriptorBuffer::int_type DescriptorBuffer::underflow()
+	{
+		if (!(mode & std::ios_base::in) || descriptor == -1)
+		{
+			return traits_type::eof();
+		}
+
+		if (gptr() < egptr())
+		{
+			return traits_type::to_int_type(*gptr());
+		}
+
+		ssize_t count = 0;
+
+		bufferOffset = this->getPosition();
+
+		do
+		{
+			count = pread(descriptor, bufferData, bufferSize, static_cast<off_t>(bufferOffset));
+		} while (count == -1 && errno == EINTR);
+
+		if (count <= 0)
+		{
+			setg(bufferData, bufferData, bufferData);
+
+			return traits_type::eof();
+		}
+
+		setg(bufferData, bufferData, bufferData + count);
+
+		return traits_type::to_int_type(*gptr());
+	}
+
+	std::streamsize DescriptorBuffer::xsgetn(char* data, std::streamsize count)
+	{
+		std::streamsize result = 0;
+
+		if (!(mode & std::ios_base::in) || descriptor == -1)
+		{
+			return result;
+		}
+
+		while (result < count)
+		{
+			if (gptr() < egptr())
+			{
+				std::streamsize available = std::min<std::streamsize>(count - result, egptr() - gptr());
+
+				std::memcpy(data + result, gptr(), static_cast<size_t>(available));
+
+				gbump(static_cast<int>(available));
+
+				result += available;
+			}
+			else if (static_cast<size_t>(count - result) < bufferSize)
+			{
+				if (traits_type::eq_int_type(this->underflow(), traits_type::eof()))
+				{
+					break;
+				}
+			}
+			else
+			{
+				// Big reads go straight to caller memory
+				uint64_t position = this->getPosition();
+				ssize_t readBytes = pread(descriptor, data + result, static_cast<size_t>(count - result), static_cast<off_t>(position));
+
+				if (readBytes == -1 && errno == EINTR)
+				{
+					continue;
+				}
+				else if (readBytes <= 0)
+				{
+					break;
+				}
+
+				result += readBytes;
+				bufferOffset = position + static_cast<uint64_t>(readBytes);
+
+				setg(bufferData, bufferData, bufferData);
+			}
+		}
+
+		return result;
+	}
+
+	std::streamsize DescriptorBuffer::showmanyc()
+	{
+		struct stat status;
+
+		if (!(mode & std::ios_base::in) || descriptor == -1 || fstat(descriptor, &status) || static_cast<uint64_t>(status.st_size) <= this->getPosition())
+		{
+			return -1;
+		}
+
+		return static_cast<std::streamsize>(static_cast<uint64_t>(status.st_size) - this->getPosition());
+	}
+
+	DescriptorBuffer::int_type DescriptorBuffer::overflow(int_type character)
+	{
+		if (!(mode & std::ios_base::out) || descriptor == -1)
+		{
+			return traits_type::eof();
+		}
+
+		if (traits_type::eq_int_type(character, traits_type::eof()))
+		{
+			return this->writeBuffer() ? traits_type::not_eof(character) : traits_type::eof();
+		}
+
+		char data = traits_type::to_char_type(character);
+
+		if (pptr() < epptr())
+		{
+			*pptr() = data;
+
+			pbump(1);
+
+			return character;
+		}
+
+		return this->writeBuffer(std::string_view(&data, 1)) ? character : traits_type::eof();
+	}
+
+	std::streamsize DescriptorBuffer::xsputn(const char* data, std::streamsize count)
+	{
+		if (!(mode & std::ios_base::out) || descriptor == -1)
+		{
+			return 0;
+		}
+
+		if (count < epptr() - pptr())
+		{
+			std::memcpy(pptr(), data, static_cast<size_t>(count));
+
+			pbump(static_cast<int>(count));
+
+			return count;
+		}
+
+		// Put area and data go to file in one call
+		return this->writeBuffer(std::string_view(data, static_cast<size_t>(count))) ? count : 0;
+	}
+
+	int DescriptorBuffer::sync()
+	{
+		if (!(mode & std::ios_base::out) || descriptor == -1)
+		{
+			return 0;
+		}
+
+		return this->writeBuffer() ? 0 : -1;
+	}
+
+	DescriptorBuffer::pos_type DescriptorBuffer::seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which)
+	{
+		switch (direction)
+		{
+		case std::ios_base::cur:
+			return this->seek(offset, SEEK_CUR, which);
+
+		case std::ios_base::end:
+			return this->seek(offset, SEEK_END, which);
+
+		default:
+			return this->seek(offset, SEEK_SET, which);
+		}
+	}
+
+	DescriptorBuffer::pos_type DescriptorBuffer::seekpos(pos_type position, std::ios_base::openmode which)
+	{
+		return this->seek(off_type(position), SEEK_SET, which);
+	}
+
+	bool DescriptorBuffer::writeVectored(std::span<const std::string_view> buffers)
+	{
+		size_t size = 0;
+
+		if (!(mode & std::ios_base::out) || descriptor == -1)
+		{
+			return false;
+		}
+
+		for (std::string_view data : buffers)
+		{
+			size += data.size();
+		}
+
+		// Small records are gathered in put area and leave with next flush
+		if (size < static_cast<size_t>(epptr() - pptr()))
+		{
+			for (std::string_view data : buffers)
+			{
+				std::memcpy(pptr(), data.data(), data.size());
+
+				pbump(static_cast<int>(data.size()));
+			}
+
+			return true;
+		}
+
+		return this->writeBuffer(buffers);
+	}
+
+	DescriptorBuffer::DescriptorBuffer() :
+		descriptor(-1),
+		node(nullptr),
+		access(DescriptorCache::Access::read),
+		mode(std::ios_base::in),
+		bufferData(nullptr),
+		bufferSize(0),
+		bufferOffset(0)
+	{
+
+	}
+
+	DescriptorBuffer* DescriptorBuffer::open(FileNode* node, std::ios_base::openmode mode)
+	{
+		DescriptorCache& descriptorCache = FileManager::getInstance().getDescriptorCache();
+		DescriptorCache::Access access = DescriptorCache::Access::read;
+
+		if (descriptor != -1)
+		{
+			return nullptr;
+		}
+
+		if (mode & std::ios_base::out)
+		{
+			access = (mode & std::ios_base::app) ? DescriptorCache::Access::append : DescriptorCache::Access::write;
+		}
+
+		try
+		{
+			descriptor = descriptorCache.acquire(node, access);
+		}
+		catch (const std::system_error&)
+		{
+			return nullptr;
+		}
+
+		// Cached descriptor is opened without O_TRUNC
+		if (access == DescriptorCache::Access::write && ftruncate(descriptor, 0))
+		{
+			descriptorCache.release(node, access, descriptor);
+
+			descriptor = -1;
+
+			return nullptr;
+		}
+
+		this->node = node;
+		this->access = access;
+
+		this->initialize(mode);
+
+		return this;
+	}
+
+	DescriptorBuffer* DescriptorBuffer::open(const std::filesystem::path& filePath, std::ios_base::openmode mode)
+	{
+		int flags = O_RDONLY;
+
+		if (descriptor != -1)
+		{
+			return nullptr;
+		}
+
+		access = DescriptorCache::Access::read;
+
+		if (mode & std::ios_base::out)
+		{
+			access = (mode & std::ios_base::app) ? DescriptorCache::Access::append : DescriptorCache::Access::write;
+			flags = (mode & std::ios_base::app) ? O_WRONLY | O_CREAT | O_APPEND : O_WRONLY | O_CREAT | O_TRUNC;
+		}
+
+		descriptor = ::open(filePath.c_str(), flags | O_CLOEXEC, 0666);
+
+		if (descriptor == -1)
+		{
+			return nullptr;
+		}
+
+		node = nullptr;
+
+		this->initialize(mode);
+
+		return this;
+	}
+
+	DescriptorBuffer* DescriptorBuffer::close(bool isCached)
+	{
+		if (descriptor == -1)
+		{
+			return nullptr;
+		}
+
+		bool isWritten = !(mode & std::ios_base::out) || !traits_type::eq_int_type(this->overflow(traits_type::eof()), traits_type::eof());
+
+		if (node && isCached)
+		{
+			FileManager::getInstance().getDescriptorCache().release(node, access, descriptor);
+		}
+		else
+		{
+			::close(descriptor);
+		}
+
+		descriptor = -1;
+		node = nullptr;
+
+		setg(nullptr, nullptr, nullptr);
+		setp(nullptr, nullptr);
+
+		return isWritten ? this : nullptr;
+	}
+
+	bool DescriptorBuffer::is_open() const
+	{
+		return descriptor != -1;
+	}
+
+	int DescriptorBuffer::getDescriptor() const
+	{
+		return descriptor;
+	}
+
+	DescriptorBuffer::~DescriptorBuffer()
+	{
+		this->close();
+	}
+}
+#endif
@@ -0,0 +1,247 @@
+#include "DescriptorCache.h"
+
+#include <system_error>
+#include <algorithm>
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <Windows.h>
+#endif
+
+namespace file_manager
+{
+	size_t DescriptorCache::KeyHash::operator () (const std::pair<FileNode*, Access>& key) const noexcept
+	{
+		return std::hash<FileNode*>()(key.first) ^ static_cast<size_t>(key.second);
+	}
+
+	FileNode::NativeHandle DescriptorCache::open(const std::filesystem::path& filePath, Access access)
+	{
+#ifdef __LINUX__
+		int flags = O_RDONLY;
+
+		switch (access)
+		{
+		case Access::write:
+			flags = O_WRONLY | O_CREAT;
+
+			break;
+
+		case Access::append:
+			flags = O_WRONLY | O_CREAT | O_APPEND;
+
+			break;
+
+		default:
+			break;
+		}
+
+		int descriptor = ::open(filePath.c_str(), flags | O_CLOEXEC, 0666);
+
+		if (descriptor == -1)
+		{
+			throw std::system_error(errno, std::generic_category(), filePath.string());
+		}
+#else
+		constexpr DWORD share = FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE;
+		HANDLE descriptor = INVALID_HANDLE_VALUE;
+
+		switch (access)
+		{
+		case Access::read:
+			descriptor = CreateFileW(filePath.c_str(), GENERIC_READ, share, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+
+			break;
+
+		case Access::write:
+			descriptor = CreateFileW(filePath.c_str(), GENERIC_WRITE, share, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+			break;
+
+		case Access::append:
+			descriptor = CreateFileW(filePath.c_str(), FILE_APPEND_DATA, share, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+			break;
+		}
+
+		if (descriptor == INVALID_HANDLE_VALUE)
+		{
+			throw std::system_error(GetLastError(), std::system_category(), filePath.string());
+		}
+#endif
+
+		return descriptor;
+	}
+
+	void DescriptorCache::close(FileNode::NativeHandle descriptor)
+	{
+#ifdef __LINUX__
+		::close(descriptor);
+#else
+		CloseHandle(descriptor);
+#endif
+	}
+
+	bool DescriptorCache::isValid(FileNode::NativeHandle descriptor)
+	{
+		// File replaced by rename or removed has no links left. FileManager invalidates its own replaces and removes, this catches external ones
+#ifdef __LINUX__
+		struct stat status;
+
+		return !fstat(descriptor, &status) && status.st_nlink;
+#else
+		BY_HANDLE_FILE_INFORMATION information;
+
+		return GetFileInformationByHandle(descriptor, &information) && information.nNumberOfLinks;
+#endif
+	}
+
+	size_t DescriptorCache::getProcessLimit()
+	{
+#ifdef __LINUX__
+		constexpr rlim_t maxLimit = 1 << 20;
+		rlimit result;
+
+		if (getrlimit(RLIMIT_NOFILE, &result))
+		{
+			return 0;
+		}
+
+		return static_cast<size_t>(std::min(result.rlim_cur, maxLimit));
+#else
+		return 2048;
+#endif
+	}
+
+	DescriptorCache::DescriptorCache() :
+		limit(DescriptorCache::getProcessLimit() / 4)
+	{
+
+	}
+
+	FileNode::NativeHandle DescriptorCache::acquire(FileNode* node, Access access)
+	{
+		const std::filesystem::path& filePath = node->getPathToFile();
+
+		{
+			std::unique_lock<std::mutex> lock(entriesMutex);
+
+			if (auto it = index.find({ node, access }); it != index.end())
+			{
+				FileNode::NativeHandle descriptor = it->second->descriptor;
+
+				entries.erase(it->second);
+				index.erase(it);
+
+				lock.unlock();
+
+				if (DescriptorCache::isValid(descriptor))
+				{
+					return descriptor;
+				}
+
+				DescriptorCache::close(descriptor);
+			}
+		}
+
+		return DescriptorCache::open(filePath, access);
+	}
+
+	void DescriptorCache::release(FileNode* node, Access access, FileNode::NativeHandle descriptor)
+	{
+		std::unique_lock<std::mutex> lock(entriesMutex);
+
+		if (!limit || index.contains({ node, access }))
+		{
+			lock.unlock();
+
+			DescriptorCache::close(descriptor);
+
+			return;
+		}
+
+		entries.push_front({ node, access, descriptor });
+		index.try_emplace({ node, access }, entries.begin());
+
+		if (entries.size() > limit)
+		{
+			Entry last = entries.back();
+
+			index.erase({ last.node, last.access });
+			entries.pop_back();
+
+			lock.unlock();
+
+			DescriptorCache::close(last.descriptor);
+		}
+	}
+
+	void DescriptorCache::invalidate(FileNode* node)
+	{
+		std::unique_lock<std::mutex> lock(entriesMutex);
+
+		for (Access access : { Access::read, Access::write, Access::append })
+		{
+			if (auto it = index.find({ node, access }); it != index.end())
+			{
+				DescriptorCache::close(it->second->descriptor);
+
+				entries.erase(it->second);
+				index.erase(it);
+			}
+		}
+	}
+
+	void DescriptorCache::clear()
+	{
+		std::unique_lock<std::mutex> lock(entriesMutex);
+
+		for (const Entry& entry : entries)
+		{
+			DescriptorCache::close(entry.descriptor);
+		}
+
+		entries.clear();
+		index.clear();
+	}
+
+	void DescriptorCache::setLimit(size_t limit)
+	{
+		std::unique_lock<std::mutex> lock(entriesMutex);
+
+		this->limit = std::min(limit, DescriptorCache::getProcessLimit() / 2);
+
+		while (entries.size() > this->limit)
+		{
+			const Entry& last = entries.back();
+
+			DescriptorCache::close(last.descriptor);
+
+			index.erase({ last.node, last.access });
+			entries.pop_back();
+		}
+	}
+
+	size_t DescriptorCache::getLimit() const
+	{
+		std::unique_lock<std::mutex> lock(entriesMutex);
+
+		return limit;
+	}
+
+	size_t DescriptorCache::size() const
+	{
+		std::unique_lock<std::mutex> lock(entriesMutex);
+
+		return entries.size();
+	}
+
+	DescriptorCache::~DescriptorCache()
+	{
+		this->clear();
+	}
+}
@@ -0,0 +1,302 @@
+#include "FileIoAwaitable.h"
+
+#include <system_error>
+
+#include "FileManager.h"
+#include "FileNode.h"
+
+#include "ThreadPool.h"
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace file_manager::_utility
+{
+	void FileIoOperation::start(FileNode* node)
+	{
+		this->node = node;
+
+#ifdef __LINUX__
+		ring = manager.getIoRing();
+
+		if (ring)
+		{
+			try
+			{
+				this->submit();
+			}
+			catch (...)
+			{
+				exception = std::current_exception();
+
+				this->finish(true);
+			}
+
+			return;
+		}
+#endif
+
+		try
+		{
+			this->execute();
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+		}
+
+		coroutine.resume();
+	}
+
+	void FileIoOperation::execute()
+	{
+		switch (kind)
+		{
+		case Kind::read:
+		{
+			auto callback = [this](ReadTextFileHandle& handle)
+				{
+					data = handle.readAllData();
+				};
+
+			transferredBytes = FileManager::execute<ReadTextFileHandle>(node, callback, false);
+
+			break;
+		}
+
+		case Kind::write:
+		{
+			auto callback = [this](WriteTextFileHandle& handle)
+				{
+					handle.write(data);
+				};
+
+			transferredBytes = FileManager::execute<WriteTextFileHandle>(node, callback, false);
+
+			break;
+		}
+
+		case Kind::append:
+		{
+			auto callback = [this](AppendFileHandle& handle)
+				{
+					handle.write(data);
+				};
+
+			transferredBytes = FileManager::execute<AppendFileHandle>(node, callback, false);
+
+			break;
+		}
+		}
+	}
+
+#ifdef __LINUX__
+	void FileIoOperation::submit()
+	{
+		switch (kind)
+		{
+		case Kind::read:
+			descriptor = node->acquireReadDescriptor();
+
+			break;
+
+		case Kind::write:
+			descriptor = open(filePath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+
+			if (descriptor == -1)
+			{
+				throw std::system_error(errno, std::generic_category(), filePath.string());
+			}
+
+			break;
+
+		case Kind::append:
+			descriptor = manager.descriptorCache.acquire(node, DescriptorCache::Access::append);
+
+			break;
+		}
+
+		if (kind == Kind::read)
+		{
+			struct stat status;
+
+			if (fstat(descriptor, &status))
+			{
+				throw std::system_error(errno, std::generic_category(), filePath.string());
+			}
+
+			data.resize(status.st_size);
+		}
+
+		if (data.empty())
+		{
+			this->finish(true);
+
+			return;
+		}
+
+		this->submitNextChunk();
+	}
+
+	void FileIoOperation::submitNextChunk()
+	{
+		char* chunk = data.data() + transferredBytes;
+		uint32_t size = static_cast<uint32_t>(std::min<uint64_t>(data.size() - transferredBytes, maxChunkSize));
+
+		switch (kind)
+		{
+		case Kind::read:
+			ring->read(this, descriptor, chunk, size, transferredBytes);
+
+			break;
+
+		case Kind::write:
+			ring->write(this, descriptor, chunk, size, transferredBytes);
+
+			break;
+
+		case Kind::append:
+			ring->write(this, descriptor, chunk, size, static_cast<uint64_t>(-1));
+
+			break;
+		}
+	}
+
+	void FileIoOperation::complete(int32_t result)
+	{
+		if (result == -EINTR || result == -EAGAIN)
+		{
+			this->submitNextChunk();
+
+			return;
+		}
+
+		if (result < 0)
+		{
+			exception = std::make_exception_ptr(std::system_error(-result, std::generic_category(), filePath.string()));
+		}
+		else if (!result)
+		{
+			if (kind == Kind::read)
+			{
+				// File is shorter than it was at open
+				data.resize(transferredBytes);
+			}
+			else
+			{
+				exception = std::make_exception_ptr(std::system_error(EIO, std::generic_category(), filePath.string()));
+			}
+		}
+		else if (transferredBytes += result; transferredBytes < data.size())
+		{
+			this->submitNextChunk();
+
+			return;
+		}
+
+		this->finish(false);
+	}
+#endif
+
+	void FileIoOperation::finish(bool isOnWorker)
+	{
+		// Request may be resumed and destroyed as soon as file is released, so copy everything needed first
+		FileManager& manager = this->manager;
+		FileNode* node = this->node;
+		std::coroutine_handle<> coroutine = this->coroutine;
+
+#ifdef __LINUX__
+		if (descriptor != -1)
+		{
+			switch (kind)
+			{
+			case Kind::read:
+				node->releaseReadDescriptor(descriptor);
+
+				break;
+
+			case Kind::write:
+				close(descriptor);
+
+				break;
+
+			case Kind::append:
+				manager.descriptorCache.release(node, DescriptorCache::Access::append, descriptor);
+
+				break;
+			}
+
+			descriptor = -1;
+		}
+#endif
+
+		if (kind == Kind::read)
+		{
+			node->completeReadRequest();
+		}
+		else
+		{
+			node->completeWriteRequest();
+		}
+
+		if (isOnWorker)
+		{
+			coroutine.resume();
+
+			return;
+		}
+
+		manager.threadPool->addTask
+		(
+			[coroutine]()
+			{
+				coroutine.resume();
+			}
+		);
+	}
+
+	FileIoOperation::FileIoOperation(FileManager& manager, const std::filesystem::path& filePath, Kind kind, std::string&& data) :
+		manager(manager),
+		filePath(filePath),
+		node(nullptr),
+		kind(kind),
+#ifdef __LINUX__
+		ring(nullptr),
+		descriptor(-1),
+#endif
+		data(std::move(data)),
+		transferredBytes(0)
+	{
+
+	}
+
+	void FileIoOperation::suspend(std::coroutine_handle<> coroutine)
+	{
+		FileNode* node = manager.getNode(filePath, kind == Kind::read);
+
+		this->coroutine = coroutine;
+
+		node->addRequest
+		(
+			[this](FileNode* node)
+			{
+				this->start(node);
+			},
+			kind == Kind::read ? FileNode::RequestType::read : FileNode::RequestType::write
+		);
+
+		// Operation may be already destroyed by resumed coroutine
+		node->processQueue();
+	}
+
+	void FileIoOperation::checkResult() const
+	{
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+	}
+}
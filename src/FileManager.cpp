@@ -1,11 +1,7 @@
 #include "FileManager.h"
 
-#include <iostream>
-
-#include "Handlers/ReadBinaryFileHandle.h"
-#include "Handlers/WriteBinaryFileHandle.h"
-#include "Handlers/AppendFileHandle.h"
-#include "Handlers/AppendBinaryFileHandle.h"
+#include <algorithm>
+#include <system_error>
 
 #include "Exceptions/FileDoesNotExistException.h"
 #include "Exceptions/NotAFileException.h"
@@ -15,248 +11,208 @@
 static std::unique_ptr<file_manager::FileManager> instance;
 static std::mutex instanceMutex;
 
-struct RequestPromiseHandler
+namespace file_manager
 {
-	std::promise<void> requestPromise;
-
-	RequestPromiseHandler(std::promise<void>&& requestPromise) :
-		requestPromise(std::move(requestPromise))
+	BatchRequest::BatchRequest(const std::filesystem::path& filePath, Executor&& executor, FileNode::RequestType type) :
+		filePath(filePath),
+		executor(std::move(executor)),
+		type(type)
 	{
 
 	}
 
-	RequestPromiseHandler(const RequestPromiseHandler& other)
+	FileManager::NodesContainer::Shard& FileManager::NodesContainer::getShard(const std::filesystem::path& filePath)
 	{
-		(*this) = other;
-	}
+		// Fibonacci hashing takes shard index from the high bits, so low bits stay well distributed for buckets inside a shard
+		constexpr uint64_t multiplier = 11400714819323198485ULL;
 
-	RequestPromiseHandler& operator = (const RequestPromiseHandler& other)
-	{
-		requestPromise = std::move(const_cast<RequestPromiseHandler&>(other).requestPromise);
-
-		return *this;
+		return shards[(static_cast<uint64_t>(utility::PathHash()(filePath)) * multiplier) >> (64 - shardsBits)];
 	}
-};
 
-namespace file_manager
-{
-	FileManager::RequestStruct::RequestStruct(FileCallback&& callback, std::promise<void>&& requestPromise, RequestFileHandleType handleType) :
-		callback(move(callback)),
-		requestPromise(move(requestPromise)),
-		handleType(handleType)
+	FileNode* FileManager::NodesContainer::addNode(const std::filesystem::path& filePath)
 	{
+		Shard& shard = this->getShard(filePath);
 
-	}
-
-	bool operator == (const FileManager::RequestStruct& request, FileManager::RequestType type)
-	{
-		return request.callback.index() == static_cast<size_t>(type);
-	}
+		{
+			std::shared_lock<std::shared_mutex> lock(shard.readWriteMutex);
 
-	FileManager::FileNode::FilePathState::FilePathState() :
-		readRequests(0),
-		isWriteRequest(false)
-	{
+			if (auto it = shard.data.find(filePath); it != shard.data.end())
+			{
+				return it->second;
+			}
+		}
 
-	}
+		std::unique_lock<std::shared_mutex> lock(shard.readWriteMutex);
 
-	void FileManager::FileNode::addRequest(FileCallback&& callback, std::promise<void>&& requestPromise, RequestFileHandleType handleType)
-	{
-		std::lock_guard<std::mutex> lock(requestsMutex);
+		if (auto it = shard.data.find(filePath); it != shard.data.end())
+		{
+			return it->second;
+		}
 
-		requests.emplace(std::move(callback), std::move(requestPromise), handleType);
+		return shard.data.try_emplace(filePath, new FileNode(filePath)).first->second;
 	}
 
-	void FileManager::FileNode::processQueue(const std::filesystem::path& filePath)
+	void FileManager::NodesContainer::addNodes(std::span<const std::filesystem::path* const> filePaths, std::span<FileNode*> outNodes)
 	{
-		std::lock_guard<std::mutex> lock(requestsMutex);
-		FileManager& manager = FileManager::getInstance();
-
-		while (requests.size())
-		{
-			RequestStruct& request = requests.front();
+		std::vector<std::pair<Shard*, size_t>> order;
 
-			if (request == RequestType::read)
-			{
-				if (state.isWriteRequest)
-				{
-					return;
-				}
+		order.reserve(filePaths.size());
 
-				state.readRequests++;
-
-				std::function<void(std::unique_ptr<ReadFileHandle>&&)> readCallback = std::move(std::get<std::function<void(std::unique_ptr<ReadFileHandle>&&)>>(request.callback));
-				RequestPromiseHandler handler(move(request.requestPromise));
-				RequestFileHandleType handleType = request.handleType;
+		for (size_t i = 0; i < filePaths.size(); i++)
+		{
+			order.emplace_back(&this->getShard(*filePaths[i]), i);
+		}
 
-				requests.pop();
+		std::sort(order.begin(), order.end());
 
-				manager.threadPool->addTask
-				(
-					[this, &manager, filePath, readCallback = std::move(readCallback), handler = std::move(handler), handleType = handleType]() mutable
-					{
-						readCallback(std::unique_ptr<ReadFileHandle>(static_cast<ReadFileHandle*>(manager.createHandle(filePath, handleType))));
+		for (auto first = order.begin(); first != order.end();)
+		{
+			Shard& shard = *first->first;
+			auto last = std::find_if(first, order.end(), [&shard](const auto& value) { return value.first != &shard; });
+			bool isMissing = false;
 
-						handler.requestPromise.set_value();
-					}
-				);
-			}
-			else if (request == RequestType::write)
 			{
-				if (state.isWriteRequest || state.readRequests)
-				{
-					return;
-				}
+				std::shared_lock<std::shared_mutex> lock(shard.readWriteMutex);
 
-				state.isWriteRequest = true;
+				for (auto it = first; it != last; ++it)
+				{
+					auto node = shard.data.find(*filePaths[it->second]);
 
-				manager.cache.clear(filePath);
+					outNodes[it->second] = node != shard.data.end() ? node->second : nullptr;
 
-				std::function<void(std::unique_ptr<WriteFileHandle>&&)> writeCallback = std::move(std::get<std::function<void(std::unique_ptr<WriteFileHandle>&&)>>(request.callback));
-				RequestPromiseHandler handler(move(request.requestPromise));
-				RequestFileHandleType handleType = request.handleType;
+					isMissing |= !outNodes[it->second];
+				}
+			}
 
-				requests.pop();
+			if (isMissing)
+			{
+				std::unique_lock<std::shared_mutex> lock(shard.readWriteMutex);
 
-				manager.threadPool->addTask
-				(
-					[this, &manager, filePath, writeCallback = std::move(writeCallback), handler = std::move(handler), handleType]() mutable
+				for (auto it = first; it != last; ++it)
+				{
+					if (!outNodes[it->second])
 					{
-						writeCallback(std::unique_ptr<WriteFileHandle>(static_cast<WriteFileHandle*>(manager.createHandle(filePath, handleType))));
+						const std::filesystem::path& filePath = *filePaths[it->second];
+						auto [node, isInserted] = shard.data.try_emplace(filePath, nullptr);
 
-						handler.requestPromise.set_value();
-					}
-				);
+						if (isInserted)
+						{
+							node->second = new FileNode(filePath);
+						}
 
-				return;
+						outNodes[it->second] = node->second;
+					}
+				}
 			}
-		}
-	}
-
-	void FileManager::NodesContainer::addNode(const std::filesystem::path& filePath)
-	{
-		std::lock_guard<std::mutex> lock(readWriteMutex);
 
-		if (data.contains(filePath))
-		{
-			return;
+			first = last;
 		}
-
-		data.try_emplace(filePath, new FileNode());
 	}
 
-	FileManager::FileNode* FileManager::NodesContainer::operator [](const std::filesystem::path& filePath) const
+	FileManager::BatchCompletion::BatchCompletion(size_t requests) :
+		remainingRequests(requests)
 	{
-		std::lock_guard<std::mutex> lock(readWriteMutex);
 
-		return data.at(filePath);
 	}
 
-	FileHandle* FileManager::createHandle(const std::filesystem::path& filePath, RequestFileHandleType handleType)
+	void FileManager::BatchCompletion::complete(std::exception_ptr requestException)
 	{
-		switch (handleType)
+		if (requestException && !hasException.test_and_set())
 		{
-		case file_manager::FileManager::RequestFileHandleType::read:
-			return new ReadFileHandle(filePath);
-
-		case file_manager::FileManager::RequestFileHandleType::write:
-			return new WriteFileHandle(filePath);
-
-		case file_manager::FileManager::RequestFileHandleType::readBinary:
-			return new ReadBinaryFileHandle(filePath);
-
-		case file_manager::FileManager::RequestFileHandleType::writeBinary:
-			return new WriteBinaryFileHandle(filePath);
+			exception = std::move(requestException);
+		}
 
-		case file_manager::FileManager::RequestFileHandleType::append:
-			return new AppendFileHandle(filePath);
+		if (remainingRequests.fetch_sub(1) != 1)
+		{
+			return;
+		}
 
-		case file_manager::FileManager::RequestFileHandleType::appendBinary:
-			return new AppendBinaryFileHandle(filePath);
+		if (exception)
+		{
+			batchPromise.set_exception(exception);
+		}
+		else
+		{
+			batchPromise.set_value();
 		}
 
-		return new FileHandle(filePath, std::ios_base::in);
+		delete this;
 	}
 
-	void FileManager::notify(std::filesystem::path&& filePath)
+	FileNode* FileManager::getNode(const std::filesystem::path& filePath, bool isFileAlreadyExist)
 	{
-		threadPool->addTask([this, tem = std::move(filePath)]()
-			{
-				nodes[tem]->processQueue(tem);
-			});
+		if (isFileAlreadyExist)
+		{
+			FileManager::checkFile(filePath);
+		}
+
+		return nodes.addNode(filePath);
 	}
 
-	void FileManager::addRequest(const std::filesystem::path& filePath, FileCallback&& callback, std::promise<void>&& requestPromise, RequestFileHandleType handleType)
+	void FileManager::checkFile(const std::filesystem::path& filePath)
 	{
-		FileNode* node = nodes[filePath];
+		std::filesystem::file_status status = std::filesystem::status(filePath);
 
-		node->addRequest(std::move(callback), std::move(requestPromise), handleType);
+		if (!std::filesystem::exists(status))
+		{
+			throw exceptions::FileDoesNotExistException(filePath);
+		}
 
-		node->processQueue(filePath);
+		if (!std::filesystem::is_regular_file(status))
+		{
+			throw exceptions::NotAFileException(filePath);
+		}
 	}
 
-	void FileManager::decreaseReadRequests(const std::filesystem::path& filePath)
+	void FileManager::notify(FileNode* node)
 	{
-		nodes[filePath]->state.readRequests--;
+		if (dispatchMode.load(std::memory_order_relaxed) != DispatchMode::deferred)
+		{
+			node->processQueue();
+
+			return;
+		}
+
+		threadPool->addTask([node]()
+			{
+				node->processQueue();
+			});
 	}
 
-	void FileManager::completeWriteRequest(const std::filesystem::path& filePath)
+#ifdef __LINUX__
+	_utility::IoRing* FileManager::getIoRing() const
 	{
-		nodes[filePath]->state.isWriteRequest = false;
+		return ioBackend == IoBackend::ioUring ? ioRing.get() : nullptr;
 	}
+#endif
 
 	FileManager::FileManager() :
-		threadPool(nullptr)
+		threadPool(nullptr),
+		dispatchMode(DispatchMode::inlineHandoff),
+		ioBackend(IoBackend::threadPool),
+		writeBufferSize(0)
 	{
 
 	}
 
 	FileManager::FileManager(size_t threadsNumber) :
-		threadPool(new threading::ThreadPool(threadsNumber))
+		threadPool(new threading::ThreadPool(threadsNumber)),
+		dispatchMode(DispatchMode::inlineHandoff),
+		ioBackend(IoBackend::threadPool),
+		writeBufferSize(0)
 	{
 
 	}
 
 	FileManager::FileManager(std::shared_ptr<threading::ThreadPool> threadPool) :
-		threadPool(threadPool)
+		threadPool(threadPool),
+		dispatchMode(DispatchMode::inlineHandoff),
+		ioBackend(IoBackend::threadPool),
+		writeBufferSize(0)
 	{
 
 	}
 
-	std::future<void> FileManager::addReadRequest(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<ReadFileHandle>&&)>& callback, RequestFileHandleType handleType, bool wait)
-	{
-		this->addFile(filePath);
-
-		std::promise<void> requestPromise;
-		std::future<void> isReady = requestPromise.get_future();
-
-		this->addRequest(filePath, callback, std::move(requestPromise), handleType);
-
-		if (wait)
-		{
-			isReady.wait();
-		}
-
-		return isReady;
-	}
-
-	std::future<void> FileManager::addWriteRequest(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<WriteFileHandle>&&)>& callback, RequestFileHandleType handleType, bool wait)
-	{
-		this->addFile(filePath, false);
-
-		std::promise<void> requestPromise;
-		std::future<void> isReady = requestPromise.get_future();
-
-		this->addRequest(filePath, callback, std::move(requestPromise), handleType);
-
-		if (wait)
-		{
-			isReady.wait();
-		}
-
-		return isReady;
-	}
-
 	FileManager& FileManager::getInstance()
 	{
 		if (!instance)
@@ -313,80 +269,232 @@ namespace file_manager
 
 	void FileManager::addFile(const std::filesystem::path& filePath, bool isFileAlreadyExist)
 	{
-		if (isFileAlreadyExist)
-		{
-			if (!std::filesystem::exists(filePath))
-			{
-				for (const auto& it : std::filesystem::directory_iterator(filePath.parent_path()))
-				{
-					std::cout << it << std::endl;
-				}
-
-				throw exceptions::FileDoesNotExistException(filePath);
-			}
-
-			if (!std::filesystem::is_regular_file(filePath))
-			{
-				throw exceptions::NotAFileException(filePath);
-			}
-		}
-
-		nodes.addNode(filePath);
+		this->getNode(filePath, isFileAlreadyExist);
 	}
 
 	std::future<void> FileManager::readFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<ReadFileHandle>&&)>& callback, bool wait)
 	{
-		return this->addReadRequest(filePath, callback, RequestFileHandleType::read, wait);
+		return this->addRequest<ReadTextFileHandle>(filePath, callback, wait);
 	}
 
 	std::future<void> FileManager::readBinaryFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<ReadFileHandle>&&)>& callback, bool wait)
 	{
-		return this->addReadRequest(filePath, callback, RequestFileHandleType::readBinary, wait);
+		return this->addRequest<ReadBinaryFileHandle>(filePath, callback, wait);
 	}
 
 	std::future<void> FileManager::writeFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<WriteFileHandle>&&)>& callback, bool wait)
 	{
-		return this->addWriteRequest(filePath, callback, RequestFileHandleType::write, wait);
+		return this->addRequest<WriteTextFileHandle>(filePath, callback, wait);
 	}
 
 	std::future<void> FileManager::appendFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<WriteFileHandle>&&)>& callback, bool wait)
 	{
-		return this->addWriteRequest(filePath, callback, RequestFileHandleType::append, wait);
+		return this->addRequest<AppendFileHandle>(filePath, callback, wait);
 	}
 
 	std::future<void> FileManager::writeBinaryFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<WriteFileHandle>&&)>& callback, bool wait)
 	{
-		return this->addWriteRequest(filePath, callback, RequestFileHandleType::writeBinary, wait);
+		return this->addRequest<WriteBinaryFileHandle>(filePath, callback, wait);
 	}
 
 	std::future<void> FileManager::appendBinaryFile(const std::filesystem::path& filePath, const std::function<void(std::unique_ptr<WriteFileHandle>&&)>& callback, bool wait)
 	{
-		return this->addWriteRequest(filePath, callback, RequestFileHandleType::appendBinary, wait);
+		return this->addRequest<AppendBinaryFileHandle>(filePath, callback, wait);
 	}
 
 	std::future<void> FileManager::removeFile(const std::filesystem::path& filePath, bool wait)
 	{
-		return this->addWriteRequest
+		return this->addRequest<WriteTextFileHandle>
 		(
 			filePath, 
-			[this](std::unique_ptr<file_manager::WriteFileHandle>&& handle)
+			[this](WriteFileHandle& handle)
 			{
-				const std::filesystem::path& path = handle->getPathToFile();
+				const std::filesystem::path& path = handle.getPathToFile();
+
+				// Closed handle doesn't put its empty data back to cache after it is cleared
+				handle.buffer.discard();
 
 				std::filesystem::remove(path);
 
 				cache.clear(path);
+				descriptorCache.invalidate(handle.node);
 			},
-			RequestFileHandleType::write, 
 			wait
 		);
 	}
 
+	FileReadAwaitable FileManager::asyncRead(const std::filesystem::path& filePath)
+	{
+		return FileReadAwaitable(*this, filePath);
+	}
+
+	FileWriteAwaitable FileManager::asyncWrite(const std::filesystem::path& filePath, std::string data)
+	{
+		return FileWriteAwaitable(*this, filePath, std::move(data));
+	}
+
+	FileAppendAwaitable FileManager::asyncAppend(const std::filesystem::path& filePath, std::string data)
+	{
+		return FileAppendAwaitable(*this, filePath, std::move(data));
+	}
+
+	std::future<void> FileManager::submitBatch(std::span<BatchRequest> requests)
+	{
+		if (requests.empty())
+		{
+			std::promise<void> emptyBatch;
+
+			emptyBatch.set_value();
+
+			return emptyBatch.get_future();
+		}
+
+		// Submitter holds one completion, so completion stays alive until every request is failed or enqueued
+		BatchCompletion* completion = new BatchCompletion(requests.size() + 1);
+		std::future<void> isReady = completion->batchPromise.get_future();
+		size_t settledRequests = 0;
+
+		try
+		{
+			std::vector<const std::filesystem::path*> filePaths;
+			std::vector<size_t> indices;
+			std::vector<FileNode*> batchNodes;
+
+			filePaths.reserve(requests.size());
+			indices.reserve(requests.size());
+
+			for (size_t i = 0; i < requests.size(); i++)
+			{
+				if (requests[i].type == RequestType::read)
+				{
+					try
+					{
+						FileManager::checkFile(requests[i].filePath);
+					}
+					catch (...)
+					{
+						completion->complete(std::current_exception());
+
+						settledRequests++;
+
+						continue;
+					}
+				}
+
+				filePaths.push_back(&requests[i].filePath);
+				indices.push_back(i);
+			}
+
+			batchNodes.resize(filePaths.size());
+
+			nodes.addNodes(filePaths, batchNodes);
+
+			FileNode::BatchScope scope;
+
+			for (size_t i = 0; i < batchNodes.size(); i++)
+			{
+				BatchRequest& request = requests[indices[i]];
+
+				batchNodes[i]->addRequest
+				(
+					[executor = std::move(request.executor), completion](FileNode* node) mutable
+					{
+						std::exception_ptr exception;
+
+						try
+						{
+							executor(node);
+						}
+						catch (...)
+						{
+							exception = std::current_exception();
+						}
+
+						completion->complete(std::move(exception));
+					},
+					request.type
+				);
+
+				settledRequests++;
+
+				batchNodes[i]->processQueue();
+			}
+		}
+		catch (...)
+		{
+			std::exception_ptr exception = std::current_exception();
+
+			// Requests that were not enqueued fail with the same exception, so future is always satisfied
+			for (; settledRequests < requests.size(); settledRequests++)
+			{
+				completion->complete(exception);
+			}
+		}
+
+		completion->complete(nullptr);
+
+		return isReady;
+	}
+
 	bool FileManager::exists(const std::filesystem::path& filePath) const
 	{
 		return std::filesystem::exists(filePath);
 	}
 
+	void FileManager::setDispatchMode(DispatchMode mode)
+	{
+		dispatchMode.store(mode, std::memory_order_relaxed);
+	}
+
+	FileManager::DispatchMode FileManager::getDispatchMode() const
+	{
+		return dispatchMode.load(std::memory_order_relaxed);
+	}
+
+	void FileManager::setIoBackend(IoBackend backend)
+	{
+		if (backend == IoBackend::ioUring)
+		{
+#ifdef __LINUX__
+			std::lock_guard<std::mutex> lock(ioRingMutex);
+
+			if (!ioRing)
+			{
+				ioRing = std::make_unique<_utility::IoRing>();
+			}
+#else
+			throw std::system_error(std::make_error_code(std::errc::function_not_supported), "io_uring");
+#endif
+		}
+
+		ioBackend = backend;
+	}
+
+	FileManager::IoBackend FileManager::getIoBackend() const
+	{
+		return ioBackend;
+	}
+
+	void FileManager::setWriteBufferSize(size_t size)
+	{
+		writeBufferSize = size;
+	}
+
+	size_t FileManager::getWriteBufferSize() const
+	{
+		return writeBufferSize;
+	}
+
+	void FileManager::setPreallocation(const std::filesystem::path& filePath, uint64_t step)
+	{
+		this->getNode(filePath, false)->setPreallocationStep(step);
+	}
+
+	uint64_t FileManager::getPreallocation(const std::filesystem::path& filePath)
+	{
+		return this->getNode(filePath, false)->getPreallocationStep();
+	}
+
 	Cache& FileManager::getCache()
 	{
 		return cache;
@@ -396,4 +504,14 @@ namespace file_manager
 	{
 		return cache;
 	}
+
+	DescriptorCache& FileManager::getDescriptorCache()
+	{
+		return descriptorCache;
+	}
+
+	const DescriptorCache& FileManager::getDescriptorCache() const
+	{
+		return descriptorCache;
+	}
 }
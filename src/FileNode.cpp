@@ -0,0 +1,668 @@
+#include "FileNode.h"
+
+#include <algorithm>
+#include <iterator>
+#include <cassert>
+
+#include "FileManager.h"
+
+#include "ThreadPool.h"
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+	thread_local file_manager::FileNode::RequestStruct* handoffRequest = nullptr;
+	thread_local bool isHandoffAllowed = false;
+	thread_local bool isHandoffAvailable = false;
+	thread_local std::vector<std::pair<file_manager::FileNode*, file_manager::FileNode::RequestStruct*>>* batchedRequests = nullptr;
+	thread_local file_manager::FileNode::GroupCommitScope* groupCommitScope = nullptr;
+}
+
+namespace file_manager
+{
+	FileNode::RequestStruct::RequestStruct(RequestCallback&& callback, RequestType type) :
+		callback(std::move(callback)),
+		type(type)
+	{
+
+	}
+
+	void* FileNode::RequestStruct::operator new(size_t size)
+	{
+		return _utility::RequestArena::allocate(size);
+	}
+
+	void FileNode::RequestStruct::operator delete(void* block) noexcept
+	{
+		_utility::RequestArena::deallocate(block);
+	}
+
+	FileNode::HandoffScope::HandoffScope(bool isEnabled) :
+		previous(std::exchange(isHandoffAvailable, isEnabled && isHandoffAllowed))
+	{
+
+	}
+
+	FileNode::HandoffScope::~HandoffScope()
+	{
+		isHandoffAvailable = previous;
+	}
+
+	FileNode::GroupCommitScope::GroupCommitScope(FileNode* node) :
+		node(node),
+		ticket(0),
+		previous(std::exchange(groupCommitScope, this))
+	{
+
+	}
+
+	bool FileNode::GroupCommitScope::defer(FileNode* node, uint64_t ticket)
+	{
+		// Nested requests of other files executed inside callback must not take the scope
+		if (!groupCommitScope || groupCommitScope->node != node || groupCommitScope->ticket)
+		{
+			return false;
+		}
+
+		groupCommitScope->ticket = ticket;
+
+		return true;
+	}
+
+	bool FileNode::GroupCommitScope::isDeferred() const
+	{
+		return ticket;
+	}
+
+	void FileNode::GroupCommitScope::commit(CommitCallback&& callback)
+	{
+		node->commitGroup(ticket, std::move(callback));
+	}
+
+	FileNode::GroupCommitScope::~GroupCommitScope()
+	{
+		groupCommitScope = previous;
+	}
+
+	FileNode::BatchScope::BatchScope() :
+		previous(std::exchange(batchedRequests, &requests))
+	{
+
+	}
+
+	FileNode::BatchScope::~BatchScope()
+	{
+		batchedRequests = previous;
+
+		FileNode::submitBatch(std::move(requests));
+	}
+
+	bool FileNode::tryAcquireRead()
+	{
+		uint64_t current = state.load();
+
+		do
+		{
+			if (current & (writerBit | writerWaitingBit))
+			{
+				return false;
+			}
+		} while (!state.compare_exchange_weak(current, current + 1));
+
+		return true;
+	}
+
+	bool FileNode::tryAcquireWrite()
+	{
+		uint64_t current = state.load();
+		uint64_t next = 0;
+
+		do
+		{
+			// Completing replace dispatches queue again
+			if (current & (writerBit | replacerBit))
+			{
+				return false;
+			}
+
+			next = (current & readersMask) ? current | writerWaitingBit : writerBit;
+		} while (!state.compare_exchange_weak(current, next));
+
+		return next == writerBit;
+	}
+
+	bool FileNode::tryAcquireReplace()
+	{
+		uint64_t current = state.load();
+
+		do
+		{
+			if (current & (writerBit | writerWaitingBit | replacerBit))
+			{
+				return false;
+			}
+		} while (!state.compare_exchange_weak(current, current | replacerBit));
+
+		return true;
+	}
+
+	void FileNode::dispatch()
+	{
+		FileManager& manager = FileManager::getInstance();
+
+		while (RequestStruct* request = blockedRequest ? blockedRequest : requests.pop())
+		{
+			blockedRequest = nullptr;
+
+			bool isAcquired = false;
+
+			switch (request->type)
+			{
+			case RequestType::read:
+				isAcquired = this->tryAcquireRead();
+
+				break;
+
+			case RequestType::write:
+				isAcquired = this->tryAcquireWrite();
+
+				if (isAcquired)
+				{
+					manager.cache.clear(filePath);
+				}
+
+				break;
+
+			case RequestType::replace:
+				// Cache is still valid for active readers, replace updates it after rename
+				isAcquired = this->tryAcquireReplace();
+
+				break;
+			}
+
+			if (!isAcquired)
+			{
+				blockedRequest = request;
+
+				return;
+			}
+
+			queuedRequests--;
+
+			this->submit(request);
+		}
+	}
+
+	void FileNode::submit(RequestStruct* request)
+	{
+		FileManager& manager = FileManager::getInstance();
+
+		if (batchedRequests)
+		{
+			batchedRequests->emplace_back(this, request);
+
+			return;
+		}
+
+		if (isHandoffAvailable && !handoffRequest && manager.dispatchMode.load(std::memory_order_relaxed) == FileManager::DispatchMode::inlineHandoff)
+		{
+			handoffRequest = request;
+
+			return;
+		}
+
+		manager.threadPool->addTask
+		(
+			[this, request]()
+			{
+				this->run(request);
+			}
+		);
+	}
+
+	void FileNode::run(RequestStruct* request)
+	{
+		for (size_t handoffs = 0; request; handoffs++)
+		{
+			std::unique_ptr<RequestStruct> owner(request);
+
+			isHandoffAllowed = handoffs < maxHandoffs;
+
+			request->callback(this);
+
+			request = std::exchange(handoffRequest, nullptr);
+		}
+
+		isHandoffAllowed = false;
+	}
+
+	void FileNode::submitBatch(std::vector<std::pair<FileNode*, RequestStruct*>>&& requests)
+	{
+		if (requests.empty())
+		{
+			return;
+		}
+
+		FileManager& manager = FileManager::getInstance();
+		auto sharedRequests = std::make_shared<std::vector<std::pair<FileNode*, RequestStruct*>>>(std::move(requests));
+		size_t tasks = std::clamp<size_t>(manager.threadPool->getThreadsCount(), 1, sharedRequests->size());
+		size_t requestsPerTask = (sharedRequests->size() + tasks - 1) / tasks;
+
+		for (size_t start = 0; start < sharedRequests->size(); start += requestsPerTask)
+		{
+			size_t end = std::min(start + requestsPerTask, sharedRequests->size());
+
+			manager.threadPool->addTask
+			(
+				[sharedRequests, start, end]()
+				{
+					for (size_t i = start; i < end; i++)
+					{
+						auto [node, request] = (*sharedRequests)[i];
+
+						node->run(request);
+					}
+				}
+			);
+		}
+	}
+
+	FileNode::FileNode(const std::filesystem::path& filePath) :
+		filePath(filePath),
+		blockedRequest(nullptr),
+		dispatchRequests(0),
+		queuedRequests(0),
+		state(0),
+		readDescriptor(),
+		readDescriptorUsers(0),
+		groupCommitWrites(0),
+		syncedWrites(0),
+		failedWrites(0),
+		groupCommitError(),
+		isGroupSyncing(false),
+		preallocationStep(0),
+		allocatedEnd(0),
+		appendedEnd(0)
+	{
+
+	}
+
+	void FileNode::addRequest(RequestCallback&& callback, RequestType type)
+	{
+		queuedRequests++;
+
+		requests.push(new RequestStruct(std::move(callback), type));
+	}
+
+	bool FileNode::tryAcquireImmediately(RequestType type)
+	{
+		if (queuedRequests)
+		{
+			return false;
+		}
+
+		if (type == RequestType::read)
+		{
+			return this->tryAcquireRead();
+		}
+		else if (type == RequestType::replace)
+		{
+			return this->tryAcquireReplace();
+		}
+
+		// Unlike tryAcquireWrite never mark writer as waiting, caller falls back to queue on failure
+		uint64_t expected = 0;
+
+		return state.compare_exchange_strong(expected, writerBit);
+	}
+
+	void FileNode::processQueue()
+	{
+		if (dispatchRequests++)
+		{
+			return;
+		}
+
+		size_t handledRequests = 0;
+
+		do
+		{
+			handledRequests = dispatchRequests;
+
+			this->dispatch();
+		} while (dispatchRequests.fetch_sub(handledRequests) != handledRequests);
+	}
+
+	void FileNode::completeReadRequest()
+	{
+		uint64_t previous = state.fetch_sub(1);
+
+		if ((previous & readersMask) == 1 && (previous & writerWaitingBit))
+		{
+			FileManager::getInstance().notify(this);
+		}
+	}
+
+	void FileNode::completeWriteRequest()
+	{
+		state.fetch_and(~writerBit);
+
+		FileManager::getInstance().notify(this);
+	}
+
+	void FileNode::completeReplaceRequest()
+	{
+		state.fetch_and(~replacerBit);
+
+		FileManager::getInstance().notify(this);
+	}
+
+	void FileNode::replace(const std::filesystem::path& sourcePath, bool isDurable)
+	{
+		std::filesystem::rename(sourcePath, filePath);
+
+		{
+			std::unique_lock<std::mutex> lock(readDescriptorMutex);
+
+			// Readers that share descriptor of previous file keep it, next reader opens new file
+			if (readDescriptorUsers)
+			{
+				retiredReadDescriptors.emplace_back(readDescriptor, readDescriptorUsers);
+
+				readDescriptorUsers = 0;
+			}
+		}
+
+		// Idle descriptors keep previous file allocated on disk
+		FileManager::getInstance().descriptorCache.invalidate(this);
+
+#ifdef __LINUX__
+		if (isDurable)
+		{
+			_utility::syncFile(filePath.has_parent_path() ? filePath.parent_path() : std::filesystem::path("."), false);
+		}
+#endif
+	}
+
+	FileNode::NativeHandle FileNode::acquireReadDescriptor()
+	{
+		std::unique_lock<std::mutex> lock(readDescriptorMutex);
+
+		if (!readDescriptorUsers)
+		{
+			readDescriptor = FileManager::getInstance().descriptorCache.acquire(this, DescriptorCache::Access::read);
+		}
+
+		readDescriptorUsers++;
+
+		return readDescriptor;
+	}
+
+	void FileNode::releaseReadDescriptor(NativeHandle descriptor)
+	{
+		std::unique_lock<std::mutex> lock(readDescriptorMutex);
+
+		if (!readDescriptorUsers || descriptor != readDescriptor)
+		{
+			auto it = std::find_if
+			(
+				retiredReadDescriptors.begin(), retiredReadDescriptors.end(),
+				[descriptor](const auto& retired)
+				{
+					return retired.first == descriptor;
+				}
+			);
+
+			// Descriptor released twice or never acquired
+			assert(it != retiredReadDescriptors.end());
+
+			if (it == retiredReadDescriptors.end())
+			{
+				return;
+			}
+
+			if (--it->second)
+			{
+				return;
+			}
+
+			retiredReadDescriptors.erase(it);
+		}
+		else if (--readDescriptorUsers)
+		{
+			return;
+		}
+
+		// Descriptor of previous file is dropped by cache validation on next acquire
+		FileManager::getInstance().descriptorCache.release(this, DescriptorCache::Access::read, descriptor);
+	}
+
+	void FileNode::sync(bool isFull)
+	{
+#ifdef __LINUX__
+		NativeHandle descriptor = this->acquireReadDescriptor();
+
+		// fdatasync and fsync flush file regardless of descriptor access mode
+		int result = isFull ? fsync(descriptor) : fdatasync(descriptor);
+		int error = errno;
+
+		this->releaseReadDescriptor(descriptor);
+
+		if (result)
+		{
+			throw std::system_error(error, std::generic_category(), filePath.string());
+		}
+#else
+		_utility::syncFile(filePath, isFull);
+#endif
+	}
+
+	uint64_t FileNode::joinGroupCommit()
+	{
+		std::unique_lock<std::mutex> lock(groupCommitMutex);
+
+		return ++groupCommitWrites;
+	}
+
+	void FileNode::commitGroup(uint64_t ticket, CommitCallback&& callback)
+	{
+		std::unique_lock<std::mutex> lock(groupCommitMutex);
+
+		if (syncedWrites >= ticket || failedWrites >= ticket)
+		{
+			std::exception_ptr exception = syncedWrites >= ticket ? nullptr : std::make_exception_ptr(std::system_error(groupCommitError, filePath.string()));
+
+			lock.unlock();
+
+			callback(exception);
+
+			return;
+		}
+
+		pendingCommits.emplace_back(ticket, std::move(callback));
+
+		if (!isGroupSyncing)
+		{
+			this->syncGroups(lock);
+		}
+	}
+
+	void FileNode::waitGroupCommit(uint64_t ticket)
+	{
+		std::unique_lock<std::mutex> lock(groupCommitMutex);
+
+		while (syncedWrites < ticket)
+		{
+			if (failedWrites >= ticket)
+			{
+				throw std::system_error(groupCommitError, filePath.string());
+			}
+
+			if (isGroupSyncing)
+			{
+				groupCommitCondition.wait(lock);
+			}
+			else
+			{
+				this->syncGroups(lock);
+			}
+		}
+	}
+
+	void FileNode::syncGroups(std::unique_lock<std::mutex>& lock)
+	{
+		std::vector<std::pair<uint64_t, CommitCallback>> completed;
+
+		isGroupSyncing = true;
+
+		do
+		{
+			// Everything joined so far is written before sync starts
+			uint64_t coveredWrites = groupCommitWrites;
+			std::exception_ptr exception;
+			std::error_code error;
+
+			lock.unlock();
+
+			try
+			{
+				this->sync(false);
+			}
+			catch (const std::system_error& syncError)
+			{
+				exception = std::current_exception();
+				error = syncError.code();
+			}
+
+			lock.lock();
+
+			if (exception)
+			{
+				failedWrites = std::max(failedWrites, coveredWrites);
+				groupCommitError = error;
+			}
+			else
+			{
+				syncedWrites = std::max(syncedWrites, coveredWrites);
+			}
+
+			auto it = std::partition
+			(
+				pendingCommits.begin(), pendingCommits.end(),
+				[coveredWrites](const auto& pending)
+				{
+					return pending.first > coveredWrites;
+				}
+			);
+
+			std::move(it, pendingCommits.end(), std::back_inserter(completed));
+
+			pendingCommits.erase(it, pendingCommits.end());
+
+			groupCommitCondition.notify_all();
+
+			lock.unlock();
+
+			for (auto& [_, callback] : completed)
+			{
+				callback(exception);
+			}
+
+			completed.clear();
+
+			lock.lock();
+		} while (pendingCommits.size());
+
+		isGroupSyncing = false;
+
+		groupCommitCondition.notify_all();
+	}
+
+	void FileNode::preallocate(NativeHandle descriptor, uint64_t offset, uint64_t end, uint64_t step)
+	{
+#ifdef __LINUX__
+		// File was truncated or replaced since last append, so is its allocated space
+		if (offset < appendedEnd)
+		{
+			allocatedEnd = 0;
+		}
+
+		appendedEnd = end;
+
+		if (end <= allocatedEnd)
+		{
+			return;
+		}
+
+		uint64_t allocationEnd = (end / step + 1) * step;
+
+		// Preallocation is only a hint, append itself reports errors
+		fallocate(descriptor, FALLOC_FL_KEEP_SIZE, static_cast<off_t>(offset), static_cast<off_t>(allocationEnd - offset));
+
+		// Failed or unsupported allocation is tried again only after next step
+		allocatedEnd = allocationEnd;
+#endif
+	}
+
+	void FileNode::trimPreallocation()
+	{
+#ifdef __LINUX__
+		if (!allocatedEnd)
+		{
+			return;
+		}
+
+		allocatedEnd = 0;
+		appendedEnd = 0;
+
+		// Opened directly, FileManager descriptor cache is already destroyed when nodes are
+		int descriptor = open(filePath.c_str(), O_WRONLY | O_CLOEXEC);
+		struct stat status;
+
+		if (descriptor == -1)
+		{
+			return;
+		}
+
+		// Truncating to the same size frees blocks allocated with FALLOC_FL_KEEP_SIZE
+		if (!fstat(descriptor, &status))
+		{
+			[[maybe_unused]] int result = ftruncate(descriptor, status.st_size);
+		}
+
+		close(descriptor);
+#endif
+	}
+
+	void FileNode::setPreallocationStep(uint64_t step)
+	{
+		preallocationStep = step;
+	}
+
+	uint64_t FileNode::getPreallocationStep() const
+	{
+		return preallocationStep;
+	}
+
+	const std::filesystem::path& FileNode::getPathToFile() const
+	{
+		return filePath;
+	}
+
+	FileNode::~FileNode()
+	{
+		this->trimPreallocation();
+
+		delete blockedRequest;
+
+		while (RequestStruct* request = requests.pop())
+		{
+			delete request;
+		}
+	}
+}
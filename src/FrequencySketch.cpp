@@ -0,0 +1,114 @@
+#include "FrequencySketch.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+	constexpr uint64_t seeds[] = { 0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL, 0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL };
+	constexpr uint64_t resetMask = 0x7777777777777777ULL;
+	constexpr size_t counterBits = 4;
+	constexpr uint64_t counterMask = 0xf;
+	constexpr size_t depth = std::size(seeds);
+	constexpr size_t sampleFactor = 10;
+}
+
+namespace file_manager::_utility
+{
+	uint64_t FrequencySketch::spread(size_t hash)
+	{
+		// Path hash may be weak in low bits, mix it before choosing words and counters
+		uint64_t result = hash;
+
+		result ^= result >> 33;
+		result *= 0xff51afd7ed558ccdULL;
+		result ^= result >> 33;
+		result *= 0xc4ceb9fe1a85ec53ULL;
+		result ^= result >> 33;
+
+		return result;
+	}
+
+	size_t FrequencySketch::indexOf(uint64_t hash, size_t row) const
+	{
+		uint64_t result = (hash + seeds[row]) * seeds[row];
+
+		result += result >> 32;
+
+		return result & (table.size() - 1);
+	}
+
+	void FrequencySketch::reset()
+	{
+		for (uint64_t& word : table)
+		{
+			word = (word >> 1) & resetMask;
+		}
+
+		additions /= 2;
+	}
+
+	FrequencySketch::FrequencySketch() :
+		table(minimumSize),
+		sampleSize(minimumSize * sampleFactor),
+		additions(0)
+	{
+
+	}
+
+	void FrequencySketch::ensureCapacity(size_t entries)
+	{
+		size_t size = std::bit_ceil(std::max(entries, minimumSize));
+
+		if (size <= table.size())
+		{
+			return;
+		}
+
+		table.assign(size, 0);
+
+		sampleSize = size * sampleFactor;
+		additions = 0;
+	}
+
+	uint32_t FrequencySketch::frequency(size_t hash) const
+	{
+		uint64_t spreadHash = spread(hash);
+		size_t start = (spreadHash & 3) << 2;
+		uint32_t result = maxFrequency;
+
+		for (size_t row = 0; row < depth; row++)
+		{
+			size_t offset = (start + row) * counterBits;
+
+			result = std::min(result, static_cast<uint32_t>((table[this->indexOf(spreadHash, row)] >> offset) & counterMask));
+		}
+
+		return result;
+	}
+
+	void FrequencySketch::increment(size_t hash)
+	{
+		uint64_t spreadHash = spread(hash);
+		size_t start = (spreadHash & 3) << 2;
+		bool isAdded = false;
+
+		for (size_t row = 0; row < depth; row++)
+		{
+			size_t offset = (start + row) * counterBits;
+			uint64_t& word = table[this->indexOf(spreadHash, row)];
+
+			if (((word >> offset) & counterMask) != maxFrequency)
+			{
+				word += 1ULL << offset;
+
+				isAdded = true;
+			}
+		}
+
+		if (isAdded && ++additions == sampleSize)
+		{
+			this->reset();
+		}
+	}
+}
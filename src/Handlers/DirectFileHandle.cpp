@@ -0,0 +1,197 @@
+#include "Handlers/DirectFileHandle.h"
+
+#include <system_error>
+#include <algorithm>
+
+#ifdef __LINUX__
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <Windows.h>
+#endif
+
+namespace file_manager
+{
+	DirectFileHandle::DirectFileHandle(FileNode* node, std::ios_base::openmode mode) :
+		FileHandle(node),
+		fileOffset(0),
+		isDirect(true)
+	{
+		const std::filesystem::path& filePath = node->getPathToFile();
+
+		// Request type is taken from mode on release
+		this->mode = mode;
+
+#ifdef __LINUX__
+		int flags = (mode & std::ios_base::out) ? O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC : O_RDONLY | O_CLOEXEC;
+
+		descriptor = open(filePath.c_str(), flags | O_DIRECT, 0666);
+
+		// File system without O_DIRECT support
+		if (descriptor == -1 && errno == EINVAL)
+		{
+			isDirect = false;
+
+			descriptor = open(filePath.c_str(), flags, 0666);
+		}
+
+		if (descriptor == -1)
+		{
+			throw std::system_error(errno, std::generic_category(), filePath.string());
+		}
+
+		if (!isDirect)
+		{
+			posix_fadvise(descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+		}
+#else
+		descriptor = (mode & std::ios_base::out) ?
+			CreateFileW(filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN, nullptr) :
+			CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+		if (descriptor == INVALID_HANDLE_VALUE)
+		{
+			throw std::system_error(GetLastError(), std::system_category(), filePath.string());
+		}
+#endif
+	}
+
+	size_t DirectFileHandle::readBlocks(std::byte* data, size_t size)
+	{
+		size_t result = 0;
+
+		while (result < size)
+		{
+#ifdef __LINUX__
+			ssize_t count = pread(descriptor, data + result, size - result, static_cast<off_t>(fileOffset));
+
+			if (count == -1)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				throw std::system_error(errno, std::generic_category(), node->getPathToFile().string());
+			}
+#else
+			OVERLAPPED position = {};
+			DWORD count = 0;
+
+			position.Offset = static_cast<DWORD>(fileOffset);
+			position.OffsetHigh = static_cast<DWORD>(fileOffset >> 32);
+
+			if (!ReadFile(descriptor, data + result, static_cast<DWORD>(std::min(size - result, _utility::AlignedBufferPool::alignDown(MAXDWORD))), &count, &position))
+			{
+				DWORD error = GetLastError();
+
+				if (error != ERROR_HANDLE_EOF)
+				{
+					throw std::system_error(error, std::system_category(), node->getPathToFile().string());
+				}
+			}
+#endif
+
+			if (!count)
+			{
+				break;
+			}
+
+			result += static_cast<size_t>(count);
+			fileOffset += static_cast<uint64_t>(count);
+
+			// Unaligned count means end of file, next read would use unaligned offset
+			if (_utility::AlignedBufferPool::alignDown(static_cast<size_t>(count)) != static_cast<size_t>(count))
+			{
+				break;
+			}
+		}
+
+		return result;
+	}
+
+	void DirectFileHandle::writeBlocks(const std::byte* data, size_t size, bool isAdvance)
+	{
+		uint64_t offset = fileOffset;
+
+		for (size_t written = 0; written < size;)
+		{
+#ifdef __LINUX__
+			ssize_t count = pwrite(descriptor, data + written, size - written, static_cast<off_t>(offset));
+
+			if (count == -1)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				throw std::system_error(errno, std::generic_category(), node->getPathToFile().string());
+			}
+#else
+			OVERLAPPED position = {};
+			DWORD count = 0;
+
+			position.Offset = static_cast<DWORD>(offset);
+			position.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			if (!WriteFile(descriptor, data + written, static_cast<DWORD>(std::min(size - written, _utility::AlignedBufferPool::alignDown(MAXDWORD))), &count, &position))
+			{
+				throw std::system_error(GetLastError(), std::system_category(), node->getPathToFile().string());
+			}
+#endif
+
+			written += static_cast<size_t>(count);
+			offset += static_cast<uint64_t>(count);
+		}
+
+		if (isAdvance)
+		{
+			fileOffset = offset;
+		}
+	}
+
+	void DirectFileHandle::truncate(uint64_t size)
+	{
+#ifdef __LINUX__
+		if (ftruncate(descriptor, static_cast<off_t>(size)))
+		{
+			throw std::system_error(errno, std::generic_category(), node->getPathToFile().string());
+		}
+#else
+		FILE_END_OF_FILE_INFO information = {};
+
+		information.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+
+		if (!SetFileInformationByHandle(descriptor, FileEndOfFileInfo, &information, sizeof(information)))
+		{
+			throw std::system_error(GetLastError(), std::system_category(), node->getPathToFile().string());
+		}
+#endif
+	}
+
+	void DirectFileHandle::release()
+	{
+		if (isNotifyOnDestruction)
+		{
+#ifdef __LINUX__
+			close(descriptor);
+#else
+			CloseHandle(descriptor);
+#endif
+		}
+
+		FileHandle::release();
+	}
+
+	bool DirectFileHandle::isUnbuffered() const
+	{
+		return isDirect;
+	}
+
+	DirectFileHandle::~DirectFileHandle()
+	{
+		this->release();
+	}
+}
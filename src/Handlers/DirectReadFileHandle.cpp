@@ -0,0 +1,89 @@
+#include "Handlers/DirectReadFileHandle.h"
+
+#include <system_error>
+#include <algorithm>
+#include <cstring>
+
+namespace file_manager
+{
+	DirectReadFileHandle::DirectReadFileHandle(FileNode* node) :
+		DirectFileHandle(node, openMode),
+		bufferBegin(0),
+		bufferEnd(0),
+		isEndOfFile(false)
+	{
+
+	}
+
+	size_t DirectReadFileHandle::read(std::span<std::byte> outData)
+	{
+		size_t result = 0;
+
+		while (result < outData.size())
+		{
+			if (bufferBegin == bufferEnd)
+			{
+				if (isEndOfFile)
+				{
+					break;
+				}
+
+				std::byte* target = outData.data() + result;
+				size_t blocksSize = _utility::AlignedBufferPool::alignDown(outData.size() - result);
+
+				if (blocksSize && _utility::AlignedBufferPool::isAligned(target))
+				{
+					size_t count = this->readBlocks(target, blocksSize);
+
+					isEndOfFile = count < blocksSize;
+					result += count;
+					transferredBytes += count;
+
+					continue;
+				}
+
+				std::span<std::byte> data = buffer.get();
+
+				bufferBegin = 0;
+				bufferEnd = this->readBlocks(data.data(), data.size());
+				isEndOfFile = bufferEnd < data.size();
+
+				if (!bufferEnd)
+				{
+					break;
+				}
+			}
+
+			size_t count = std::min(bufferEnd - bufferBegin, outData.size() - result);
+
+			std::memcpy(outData.data() + result, buffer.get().data() + bufferBegin, count);
+
+			bufferBegin += count;
+			result += count;
+			transferredBytes += count;
+		}
+
+		return result;
+	}
+
+	std::string DirectReadFileHandle::readAllData()
+	{
+		uint64_t fileSize = this->getFileSize();
+		uint64_t position = fileOffset - (bufferEnd - bufferBegin);
+		std::string result(static_cast<size_t>(fileSize - std::min(position, fileSize)), '\0');
+
+		result.resize(this->read(std::as_writable_bytes(std::span<char>(result))));
+
+		// File may grow after size was taken
+		while (!isEndOfFile || bufferBegin != bufferEnd)
+		{
+			std::span<std::byte> data = buffer.get();
+			size_t previousSize = result.size();
+
+			result.resize(previousSize + data.size());
+			result.resize(previousSize + this->read(std::as_writable_bytes(std::span<char>(result)).subspan(previousSize)));
+		}
+
+		return result;
+	}
+}
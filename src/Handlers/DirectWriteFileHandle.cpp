@@ -0,0 +1,112 @@
+#include "Handlers/DirectWriteFileHandle.h"
+
+#include <system_error>
+#include <algorithm>
+#include <cstring>
+
+namespace file_manager
+{
+	DirectWriteFileHandle::DirectWriteFileHandle(FileNode* node) :
+		DirectFileHandle(node, openMode),
+		bufferedBytes(0)
+	{
+
+	}
+
+	void DirectWriteFileHandle::writeBuffer()
+	{
+		size_t blocksSize = _utility::AlignedBufferPool::alignDown(bufferedBytes);
+		std::byte* data = buffer.get().data();
+
+		if (!blocksSize)
+		{
+			return;
+		}
+
+		this->writeBlocks(data, blocksSize);
+
+		bufferedBytes -= blocksSize;
+
+		std::memmove(data, data + blocksSize, bufferedBytes);
+	}
+
+	void DirectWriteFileHandle::release()
+	{
+		if (isNotifyOnDestruction)
+		{
+			try
+			{
+				this->flush();
+			}
+			catch (const std::system_error&)
+			{
+				// Same as std::fstream destructor, call flush explicitly to get errors
+			}
+		}
+
+		DirectFileHandle::release();
+	}
+
+	void DirectWriteFileHandle::write(std::span<const std::byte> data)
+	{
+		std::span<std::byte> bufferData = buffer.get();
+
+		while (data.size())
+		{
+			if (!bufferedBytes && _utility::AlignedBufferPool::isAligned(data.data()))
+			{
+				if (size_t blocksSize = _utility::AlignedBufferPool::alignDown(data.size()))
+				{
+					this->writeBlocks(data.data(), blocksSize);
+
+					transferredBytes += blocksSize;
+					data = data.subspan(blocksSize);
+
+					continue;
+				}
+			}
+
+			size_t count = std::min(bufferData.size() - bufferedBytes, data.size());
+
+			std::memcpy(bufferData.data() + bufferedBytes, data.data(), count);
+
+			bufferedBytes += count;
+			transferredBytes += count;
+			data = data.subspan(count);
+
+			if (bufferedBytes == bufferData.size())
+			{
+				this->writeBuffer();
+			}
+		}
+	}
+
+	void DirectWriteFileHandle::write(std::string_view data)
+	{
+		this->write(std::as_bytes(std::span<const char>(data)));
+	}
+
+	void DirectWriteFileHandle::flush()
+	{
+		this->writeBuffer();
+
+		if (!bufferedBytes)
+		{
+			return;
+		}
+
+		// Unbuffered writes must cover whole blocks, so tail is padded, written without advancing and cut off by truncate
+		std::byte* data = buffer.get().data();
+		size_t paddedSize = _utility::AlignedBufferPool::alignUp(bufferedBytes);
+
+		std::memset(data + bufferedBytes, 0, paddedSize - bufferedBytes);
+
+		this->writeBlocks(data, paddedSize, false);
+		this->truncate(fileOffset + bufferedBytes);
+	}
+
+	DirectWriteFileHandle::~DirectWriteFileHandle()
+	{
+		this->release();
+	}
+}
@@ -1,13 +1,24 @@
 #include "Handlers/FileHandle.h"
 
 #include "FileManager.h"
+#include "FileNode.h"
 
 namespace file_manager
 {
-	FileHandle::FileHandle(const std::filesystem::path& filePath, std::ios_base::openmode mode) :
-		filePath(filePath),
-		file(filePath, mode),
+	FileHandle::FileHandle(FileNode* node, std::ios_base::openmode mode) :
+		node(node),
+		file(node->getPathToFile(), mode),
 		mode(mode),
+		transferredBytes(0),
+		isNotifyOnDestruction(true)
+	{
+
+	}
+
+	FileHandle::FileHandle(FileNode* node) :
+		node(node),
+		mode(std::ios_base::in),
+		transferredBytes(0),
 		isNotifyOnDestruction(true)
 	{
 
@@ -20,9 +31,10 @@ namespace file_manager
 
 	FileHandle& FileHandle::operator = (FileHandle&& other) noexcept
 	{
-		filePath = std::move(other.filePath);
+		node = other.node;
 		file = move(other.file);
 		mode = other.mode;
+		transferredBytes = other.transferredBytes;
 
 		isNotifyOnDestruction = other.isNotifyOnDestruction;
 
@@ -33,26 +45,47 @@ namespace file_manager
 
 	uint64_t FileHandle::getFileSize() const
 	{
-		return std::filesystem::file_size(filePath);
+		return std::filesystem::file_size(node->getPathToFile());
 	}
 
 	const std::filesystem::path& FileHandle::getPathToFile() const
 	{
-		return filePath;
+		return node->getPathToFile();
 	}
 
 	std::filesystem::path FileHandle::getFileName() const
 	{
-		return filePath.filename();
+		return node->getPathToFile().filename();
 	}
 
-	FileHandle::~FileHandle()
+	uint64_t FileHandle::getTransferredBytes() const
 	{
-		if (isNotifyOnDestruction)
+		return transferredBytes;
+	}
+
+	void FileHandle::release()
+	{
+		if (!isNotifyOnDestruction)
 		{
-			file.close();
+			return;
+		}
 
-			FileManager::getInstance().notify(std::move(filePath));
+		isNotifyOnDestruction = false;
+
+		file.close();
+
+		if (mode & std::ios_base::out)
+		{
+			node->completeWriteRequest();
+		}
+		else
+		{
+			node->completeReadRequest();
 		}
 	}
+
+	FileHandle::~FileHandle()
+	{
+		this->release();
+	}
 }
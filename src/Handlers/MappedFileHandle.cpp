@@ -0,0 +1,190 @@
+#include "Handlers/MappedFileHandle.h"
+
+#include <system_error>
+#include <algorithm>
+
+#include "FileNode.h"
+
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <Windows.h>
+#endif
+
+namespace file_manager
+{
+	MappedFileHandle::MappedFileHandle(FileNode* node) :
+		FileHandle(node),
+		data(nullptr),
+		size(0)
+#ifndef __LINUX__
+		, mapping(nullptr)
+#endif
+	{
+		const std::filesystem::path& filePath = node->getPathToFile();
+
+#ifdef __LINUX__
+		int descriptor = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+		struct stat status;
+
+		if (descriptor == -1)
+		{
+			throw std::system_error(errno, std::generic_category(), filePath.string());
+		}
+
+		if (fstat(descriptor, &status))
+		{
+			int error = errno;
+
+			close(descriptor);
+
+			throw std::system_error(error, std::generic_category(), filePath.string());
+		}
+
+		size = static_cast<size_t>(status.st_size);
+
+		if (size)
+		{
+			void* result = mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+			if (result == MAP_FAILED)
+			{
+				int error = errno;
+
+				close(descriptor);
+
+				throw std::system_error(error, std::generic_category(), filePath.string());
+			}
+
+			data = static_cast<const std::byte*>(result);
+		}
+
+		// Mapping keeps file referenced
+		close(descriptor);
+
+		this->advise(Advice::sequential);
+#else
+		HANDLE file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		LARGE_INTEGER fileSize;
+
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			throw std::system_error(GetLastError(), std::system_category(), filePath.string());
+		}
+
+		if (!GetFileSizeEx(file, &fileSize))
+		{
+			DWORD error = GetLastError();
+
+			CloseHandle(file);
+
+			throw std::system_error(error, std::system_category(), filePath.string());
+		}
+
+		size = static_cast<size_t>(fileSize.QuadPart);
+
+		if (size)
+		{
+			mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+			if (mapping)
+			{
+				data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			}
+
+			if (!data)
+			{
+				DWORD error = GetLastError();
+
+				if (mapping)
+				{
+					CloseHandle(mapping);
+				}
+
+				CloseHandle(file);
+
+				throw std::system_error(error, std::system_category(), filePath.string());
+			}
+		}
+
+		// Mapping keeps file referenced
+		CloseHandle(file);
+#endif
+	}
+
+	std::span<const std::byte> MappedFileHandle::getData() const
+	{
+		return std::span<const std::byte>(data, size);
+	}
+
+	std::string_view MappedFileHandle::getView() const
+	{
+		return std::string_view(reinterpret_cast<const char*>(data), size);
+	}
+
+	void MappedFileHandle::advise(Advice advice, size_t offset, size_t count)
+	{
+		if (offset >= size)
+		{
+			return;
+		}
+
+		count = std::min(count, size - offset);
+
+#ifdef __LINUX__
+		static const long pageSize = sysconf(_SC_PAGESIZE);
+		int linuxAdvice = MADV_NORMAL;
+
+		switch (advice)
+		{
+		case Advice::sequential:
+			linuxAdvice = MADV_SEQUENTIAL;
+
+			break;
+
+		case Advice::random:
+			linuxAdvice = MADV_RANDOM;
+
+			break;
+
+		case Advice::willNeed:
+			linuxAdvice = MADV_WILLNEED;
+
+			break;
+
+		default:
+			break;
+		}
+
+		// madvise requires page aligned address
+		size_t alignedOffset = offset - offset % pageSize;
+
+		madvise(const_cast<std::byte*>(data) + alignedOffset, count + offset - alignedOffset, linuxAdvice);
+#else
+		if (advice == Advice::willNeed)
+		{
+			WIN32_MEMORY_RANGE_ENTRY range = { const_cast<std::byte*>(data) + offset, count };
+
+			PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+		}
+#endif
+	}
+
+	MappedFileHandle::~MappedFileHandle()
+	{
+		if (!data)
+		{
+			return;
+		}
+
+#ifdef __LINUX__
+		munmap(const_cast<std::byte*>(data), size);
+#else
+		UnmapViewOfFile(data);
+		CloseHandle(mapping);
+#endif
+	}
+}
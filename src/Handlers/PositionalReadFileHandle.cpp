@@ -0,0 +1,125 @@
+#include "Handlers/PositionalReadFileHandle.h"
+
+#include <system_error>
+#include <algorithm>
+
+#ifdef __LINUX__
+#include <cerrno>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <Windows.h>
+#endif
+
+namespace file_manager
+{
+	PositionalReadFileHandle::PositionalReadFileHandle(FileNode* node) :
+		FileHandle(node),
+		descriptor(node->acquireReadDescriptor())
+	{
+
+	}
+
+	void PositionalReadFileHandle::release()
+	{
+		if (isNotifyOnDestruction)
+		{
+			node->releaseReadDescriptor(descriptor);
+		}
+
+		FileHandle::release();
+	}
+
+	size_t PositionalReadFileHandle::read(std::span<std::byte> outData, uint64_t offset)
+	{
+		size_t result = 0;
+
+		while (result < outData.size())
+		{
+#ifdef __LINUX__
+			ssize_t count = pread(descriptor, outData.data() + result, outData.size() - result, static_cast<off_t>(offset + result));
+
+			if (count == -1)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+
+				throw std::system_error(errno, std::generic_category(), node->getPathToFile().string());
+			}
+#else
+			OVERLAPPED position = {};
+			uint64_t currentOffset = offset + result;
+			DWORD count = 0;
+
+			position.Offset = static_cast<DWORD>(currentOffset);
+			position.OffsetHigh = static_cast<DWORD>(currentOffset >> 32);
+
+			if (!ReadFile(descriptor, outData.data() + result, static_cast<DWORD>(std::min<size_t>(outData.size() - result, MAXDWORD)), &count, &position))
+			{
+				DWORD error = GetLastError();
+
+				if (error == ERROR_HANDLE_EOF)
+				{
+					break;
+				}
+
+				throw std::system_error(error, std::system_category(), node->getPathToFile().string());
+			}
+#endif
+
+			if (!count)
+			{
+				break;
+			}
+
+			result += static_cast<size_t>(count);
+		}
+
+		transferredBytes += result;
+
+		return result;
+	}
+
+	std::string PositionalReadFileHandle::readData(uint64_t offset, size_t count)
+	{
+		std::string result(count, '\0');
+
+		result.resize(this->read(std::as_writable_bytes(std::span<char>(result)), offset));
+
+		return result;
+	}
+
+	std::string PositionalReadFileHandle::readAllData()
+	{
+		uint64_t size = 0;
+
+#ifdef __LINUX__
+		struct stat status;
+
+		if (fstat(descriptor, &status))
+		{
+			throw std::system_error(errno, std::generic_category(), node->getPathToFile().string());
+		}
+
+		size = static_cast<uint64_t>(status.st_size);
+#else
+		LARGE_INTEGER fileSize;
+
+		if (!GetFileSizeEx(descriptor, &fileSize))
+		{
+			throw std::system_error(GetLastError(), std::system_category(), node->getPathToFile().string());
+		}
+
+		size = static_cast<uint64_t>(fileSize.QuadPart);
+#endif
+
+		return this->readData(0, static_cast<size_t>(size));
+	}
+
+	PositionalReadFileHandle::~PositionalReadFileHandle()
+	{
+		this->release();
+	}
+}
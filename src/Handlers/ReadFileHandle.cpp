@@ -1,8 +1,13 @@
 #include "Handlers/ReadFileHandle.h"
 
 #include "FileManager.h"
+#include "FileNode.h"
 #include "Exceptions/FileDoesNotExistException.h"
 
+#ifdef __LINUX__
+#include <fcntl.h>
+#endif
+
 namespace file_manager
 {
 	ReadFileHandle::ReadOnlyBuffer::ReadOnlyBuffer(std::string_view view)
@@ -12,35 +17,76 @@ namespace file_manager
 		setg(data, data, data + view.size());
 	}
 
-	ReadFileHandle::ReadFileHandle(const std::filesystem::path& filePath, std::ios_base::openmode mode) :
-		FileHandle(filePath, mode | std::ios_base::in)
+	ReadFileHandle::ReadFileHandle(FileNode* node, std::ios_base::openmode mode) :
+		FileHandle(node),
+		accessPattern(AccessPattern::normal)
 	{
 		Cache& cache = FileManager::getInstance().getCache();
+		const std::filesystem::path& filePath = node->getPathToFile();
+
+		this->mode = mode | std::ios_base::in;
 
-		if (cache.contains(filePath))
+		if (cachedData = cache.shareCacheData(filePath))
 		{
-			buffer = make_unique<ReadOnlyBuffer>(cache.getCacheData(filePath));
+			buffer.emplace(*cachedData);
+
+			static_cast<std::iostream& > (file).rdbuf(&*buffer);
 
-			static_cast<std::iostream& > (file).rdbuf(buffer.get());
+			return;
+		}
+
+#ifdef __LINUX__
+		if (descriptorBuffer.open(node, this->mode))
+		{
+			static_cast<std::iostream&>(file).rdbuf(&descriptorBuffer);
 		}
+		else
+		{
+			file.setstate(std::ios_base::failbit);
+		}
+#else
+		file.open(filePath, this->mode);
+#endif
 	}
 
 	const std::string& ReadFileHandle::readAllData()
 	{
 		Cache& cache = FileManager::getInstance().getCache();
+		const std::filesystem::path& filePath = node->getPathToFile();
+
+		std::shared_ptr<const std::string> result;
 
-		switch (cache.addCache(filePath, mode))
+		if (cachedData)
 		{
-		case Cache::CacheResultCodes::noError:
-			return cache.getCacheData(filePath);
+			transferredBytes += cachedData->size();
+
+			return *cachedData;
+		}
+
+		// File is read through request stream, so access pattern applies and file is not opened again
+		file.seekg(0);
 
+		switch (cache.addCache(filePath, file, result))
+		{
 		case Cache::CacheResultCodes::fileDoesNotExist:
 			throw exceptions::FileDoesNotExistException(filePath);
 
-		case Cache::CacheResultCodes::notEnoughCacheSize:
-			data = (std::ostringstream() << file.rdbuf()).str();
+		default:
+			// Data is shared even if it was not admitted to cache or was evicted after that
+			if (result)
+			{
+				cachedData = std::move(result);
+
+				transferredBytes += cachedData->size();
+
+				return *cachedData;
+			}
+
+			_utility::readAll(file, data);
 		}
 
+		transferredBytes += data.size();
+
 		return data;
 	}
 
@@ -53,6 +99,8 @@ namespace file_manager
 
 		std::streamsize result = file.read(outData.data(), count).gcount();
 
+		transferredBytes += result;
+
 		if (shrinkOutData && outData.size() != result)
 		{
 			outData.resize(result);
@@ -66,11 +114,77 @@ namespace file_manager
 		return file.read(nullptr, 0);
 	}
 
-	ReadFileHandle::~ReadFileHandle()
+	void ReadFileHandle::release()
 	{
-		if (isNotifyOnDestruction)
+#ifdef __LINUX__
+		if (isNotifyOnDestruction && descriptorBuffer.is_open())
 		{
-			FileManager::getInstance().decreaseReadRequests(filePath);
+			int descriptor = descriptorBuffer.getDescriptor();
+
+			if (accessPattern == AccessPattern::dontNeed)
+			{
+				posix_fadvise(descriptor, 0, 0, POSIX_FADV_DONTNEED);
+			}
+
+			// Hint stays on cached descriptor, next request starts with default readahead
+			if (accessPattern != AccessPattern::normal)
+			{
+				posix_fadvise(descriptor, 0, 0, POSIX_FADV_NORMAL);
+			}
+
+			descriptorBuffer.close();
 		}
+#endif
+
+		FileHandle::release();
+	}
+
+	void ReadFileHandle::setAccessPattern(AccessPattern accessPattern)
+	{
+		this->accessPattern = accessPattern;
+
+#ifdef __LINUX__
+		// Cached file is not read from disk
+		if (!descriptorBuffer.is_open())
+		{
+			return;
+		}
+
+		int advice = POSIX_FADV_NORMAL;
+
+		switch (accessPattern)
+		{
+		case AccessPattern::sequential:
+		case AccessPattern::dontNeed:
+			advice = POSIX_FADV_SEQUENTIAL;
+
+			break;
+
+		case AccessPattern::random:
+			advice = POSIX_FADV_RANDOM;
+
+			break;
+
+		case AccessPattern::willNeed:
+			advice = POSIX_FADV_WILLNEED;
+
+			break;
+
+		default:
+			break;
+		}
+
+		posix_fadvise(descriptorBuffer.getDescriptor(), 0, 0, advice);
+#endif
+	}
+
+	ReadFileHandle::AccessPattern ReadFileHandle::getAccessPattern() const
+	{
+		return accessPattern;
+	}
+
+	ReadFileHandle::~ReadFileHandle()
+	{
+		this->release();
 	}
 }
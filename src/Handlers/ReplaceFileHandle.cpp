@@ -0,0 +1,141 @@
+#include "Handlers/ReplaceFileHandle.h"
+
+#include <atomic>
+#include <random>
+#include <exception>
+#include <system_error>
+
+#include "FileManager.h"
+
+namespace file_manager
+{
+	std::filesystem::path ReplaceFileHandle::makeTemporaryPath(const std::filesystem::path& filePath)
+	{
+		// Nonce separates processes that replace the same file, counter separates replaces of this process
+		static const uint64_t nonce = (static_cast<uint64_t>(std::random_device()()) << 32) | std::random_device()();
+		static std::atomic_uint64_t counter = 0;
+		std::filesystem::path fileName = ".";
+
+		fileName += filePath.filename();
+		fileName += '.' + std::to_string(nonce) + '.' + std::to_string(counter++) + ".tmp";
+
+		return std::filesystem::path(filePath).replace_filename(fileName);
+	}
+
+	ReplaceFileHandle::ReplaceFileHandle(FileNode* node, std::ios_base::openmode mode, std::filesystem::path&& temporaryPath) :
+		WriteFileHandle(node, temporaryPath, mode & ~std::ios_base::app),
+		temporaryPath(std::move(temporaryPath)),
+		uncaughtExceptions(std::uncaught_exceptions())
+	{
+		std::error_code error;
+		std::filesystem::file_status status = std::filesystem::status(node->getPathToFile(), error);
+
+		// Replaced file keeps its permissions
+		if (buffer.is_open() && std::filesystem::exists(status))
+		{
+			std::filesystem::permissions(this->temporaryPath, status.permissions(), error);
+		}
+	}
+
+	ReplaceFileHandle::ReplaceFileHandle(FileNode* node, std::ios_base::openmode mode) :
+		ReplaceFileHandle(node, mode, ReplaceFileHandle::makeTemporaryPath(node->getPathToFile()))
+	{
+
+	}
+
+	void ReplaceFileHandle::discard()
+	{
+		if (!isNotifyOnDestruction)
+		{
+			return;
+		}
+
+		std::error_code error;
+
+		buffer.closeFile();
+		buffer.commitCache(false);
+
+		std::filesystem::remove(temporaryPath, error);
+
+		isNotifyOnDestruction = false;
+
+		node->completeReplaceRequest();
+	}
+
+	void ReplaceFileHandle::release()
+	{
+		if (!isNotifyOnDestruction)
+		{
+			return;
+		}
+
+		std::exception_ptr exception;
+
+		file.flush();
+
+		try
+		{
+			if (!buffer.closeFile())
+			{
+				throw std::system_error(std::make_error_code(std::errc::io_error), temporaryPath.string());
+			}
+
+			// Data must be on storage before rename, otherwise crash may leave empty file in place of previous one
+			_utility::syncFile(temporaryPath, durability == Durability::fullSync);
+
+			node->replace(temporaryPath, durability != Durability::none);
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+		}
+
+		if (exception)
+		{
+			std::error_code error;
+
+			buffer.commitCache(false);
+
+			std::filesystem::remove(temporaryPath, error);
+		}
+		else if (!buffer.commitCache(true))
+		{
+			// Previous data must not be read from cache after rename
+			FileManager::getInstance().getCache().clear(node->getPathToFile());
+		}
+
+		isNotifyOnDestruction = false;
+
+		node->completeReplaceRequest();
+
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
+	}
+
+	const std::filesystem::path& ReplaceFileHandle::getTemporaryPath() const
+	{
+		return temporaryPath;
+	}
+
+	ReplaceFileHandle::~ReplaceFileHandle()
+	{
+		// Handle destroyed by exception from callback must not replace file with partial data
+		if (std::uncaught_exceptions() > uncaughtExceptions)
+		{
+			this->discard();
+
+			return;
+		}
+
+		try
+		{
+			this->release();
+		}
+		catch (const std::system_error&)
+		{
+			// Call release explicitly to get errors
+		}
+	}
+}
@@ -1,70 +1,461 @@
 #include "Handlers/WriteFileHandle.h"
 
+#include <exception>
+
 #include "FileManager.h"
 
 namespace file_manager
 {
-	bool WriteFileHandle::CachingBuffer::increaseCacheData()
+	WriteFileHandle::FlushPolicy WriteFileHandle::FlushPolicy::perCall()
+	{
+		return FlushPolicy();
+	}
+
+	WriteFileHandle::FlushPolicy WriteFileHandle::FlushPolicy::everyBytes(uint64_t threshold)
+	{
+		return FlushPolicy{ Type::bytes, threshold };
+	}
+
+	WriteFileHandle::FlushPolicy WriteFileHandle::FlushPolicy::every(std::chrono::milliseconds interval)
+	{
+		return FlushPolicy{ Type::interval, 0, interval };
+	}
+
+	WriteFileHandle::FlushPolicy WriteFileHandle::FlushPolicy::onClose()
+	{
+		return FlushPolicy{ Type::onClose };
+	}
+
+	bool WriteFileHandle::CachingBuffer::increaseCacheData(std::string_view data)
 	{
 		if (!isCachingAvailable)
 		{
 			return false;
 		}
 
-		std::string_view availableCacheData(pbase(), pptr());
+		std::string_view availableCacheData(pbase() + recordedBytes, pptr());
 
-		if (availableCacheData.size() + cache.getCurrentCacheSize() > cache.getCacheSize())
+		// Cached entries are evicted for written data on close, so only reservations of writers are limited
+		if (availableCacheData.size() + data.size() + cache.getReservedCacheSize() > cache.getCacheSize())
 		{
 			isCachingAvailable = false;
 
 			_utility::changeCurrentCacheSize<std::minus>(cacheData.size());
 
-			cacheData.clear();
+			cacheData = std::string();
 
 			return false;
 		}
 
-		_utility::changeCurrentCacheSize<std::plus>(availableCacheData.size());
+		_utility::changeCurrentCacheSize<std::plus>(availableCacheData.size() + data.size());
 
 		cacheData += availableCacheData;
+		cacheData += data;
+
+		recordedBytes = pptr() - pbase();
 
 		return true;
 	}
 
-	WriteFileHandle::CachingBuffer::CachingBuffer(Cache& cache, const std::filesystem::path& filePath, std::ios_base::openmode mode) :
-		cache(cache),
-		filePath(filePath),
-		isCachingAvailable(cache.getCacheSize())
+	std::streamsize WriteFileHandle::CachingBuffer::xsputn(const char* data, std::streamsize count)
+	{
+		// Data is taken before writing because big writes bypass put area
+		this->increaseCacheData(std::string_view(data, static_cast<size_t>(count)));
+
+		isInsideWrite = true;
+
+		std::streamsize result = FileBuffer::xsputn(data, count);
+
+		isInsideWrite = false;
+		recordedBytes = pptr() - pbase();
+
+		return result;
+	}
+
+	WriteFileHandle::CachingBuffer::int_type WriteFileHandle::CachingBuffer::overflow(int_type character)
 	{
-		open(filePath, mode);
+		// Called from xsputn with data that is already taken
+		if (isInsideWrite)
+		{
+			return FileBuffer::overflow(character);
+		}
+
+		if (traits_type::eq_int_type(character, traits_type::eof()))
+		{
+			this->increaseCacheData();
+		}
+		else
+		{
+			char data = traits_type::to_char_type(character);
+
+			this->increaseCacheData(std::string_view(&data, 1));
+		}
+
+		int_type result = FileBuffer::overflow(character);
+
+		recordedBytes = pptr() - pbase();
+
+		return result;
 	}
 
 	int WriteFileHandle::CachingBuffer::sync()
 	{
 		this->increaseCacheData();
 
-		return std::filebuf::sync();
+		int result = FileBuffer::sync();
+
+		recordedBytes = pptr() - pbase();
+
+		return result;
+	}
+
+#ifdef __LINUX__
+	bool WriteFileHandle::CachingBuffer::writeVectored(std::span<const std::string_view> buffers)
+	{
+		// Data is taken before writing because buffers bypass put area
+		this->increaseCacheData();
+
+		for (std::string_view data : buffers)
+		{
+			this->increaseCacheData(data);
+		}
+
+		bool result = FileBuffer::writeVectored(buffers);
+
+		recordedBytes = pptr() - pbase();
+
+		return result;
+	}
+#endif
+
+	WriteFileHandle::CachingBuffer::CachingBuffer(Cache& cache, FileNode* node, const std::filesystem::path& writePath, std::ios_base::openmode mode, char* buffer, size_t bufferSize) :
+		cache(cache),
+		filePath(node->getPathToFile()),
+		recordedBytes(0),
+		// Appended data is only a part of the file
+		isCachingAvailable(cache.getCacheSize() && !(mode & std::ios_base::app)),
+		isInsideWrite(false)
+	{
+		if (buffer)
+		{
+			this->pubsetbuf(buffer, static_cast<std::streamsize>(bufferSize));
+		}
+
+#ifdef __LINUX__
+		if (writePath == filePath)
+		{
+			open(node, mode);
+
+			return;
+		}
+#endif
+
+		open(writePath, mode);
+	}
+
+	WriteFileHandle::CachingBuffer* WriteFileHandle::CachingBuffer::close()
+	{
+		if (!is_open())
+		{
+			return nullptr;
+		}
+
+		bool isWritten = this->closeFile();
+
+		this->commitCache(isWritten);
+
+		return isWritten ? this : nullptr;
+	}
+
+	bool WriteFileHandle::CachingBuffer::closeFile()
+	{
+		// Pending data is taken by overflow
+		bool result = FileBuffer::close();
+
+		recordedBytes = 0;
+
+		return result;
+	}
+
+	void WriteFileHandle::CachingBuffer::discard()
+	{
+		this->commitCache(false);
+
+#ifdef __LINUX__
+		// Descriptor of removed file would only displace cached ones
+		FileBuffer::close(false);
+#else
+		FileBuffer::close();
+#endif
+
+		recordedBytes = 0;
+	}
+
+	bool WriteFileHandle::CachingBuffer::commitCache(bool isWritten)
+	{
+		if (!isCachingAvailable)
+		{
+			return false;
+		}
+
+		isCachingAvailable = false;
+
+		if (isWritten)
+		{
+			_utility::addCache(std::move(filePath), std::move(cacheData));
+		}
+		else
+		{
+			_utility::changeCurrentCacheSize<std::minus>(cacheData.size());
+		}
+
+		return isWritten;
 	}
 
 	WriteFileHandle::CachingBuffer::~CachingBuffer()
 	{
-		if (!this->increaseCacheData())
+		this->close();
+	}
+
+	WriteFileHandle::WriteFileHandle(FileNode* node, std::ios_base::openmode mode) :
+		WriteFileHandle(node, node->getPathToFile(), mode)
+	{
+
+	}
+
+	WriteFileHandle::WriteFileHandle(FileNode* node, const std::filesystem::path& writePath, std::ios_base::openmode mode) :
+		FileHandle(node),
+		bufferData(FileManager::getInstance().getWriteBufferSize() ? new char[FileManager::getInstance().getWriteBufferSize()] : nullptr),
+		buffer(FileManager::getInstance().getCache(), node, writePath, mode | std::ios_base::out, bufferData.get(), FileManager::getInstance().getWriteBufferSize()),
+		durability(Durability::none),
+		preallocation{ node->getPreallocationStep() },
+		appendEnd(unknownEnd),
+		unflushedBytes(0),
+		lastFlush(std::chrono::steady_clock::now())
+	{
+		this->mode = mode | std::ios_base::out;
+
+		static_cast<std::iostream&>(file).rdbuf(&buffer);
+
+		if (!buffer.is_open())
+		{
+			file.setstate(std::ios_base::failbit);
+		}
+	}
+
+	void WriteFileHandle::flushIfNeeded(uint64_t writtenBytes)
+	{
+		unflushedBytes += writtenBytes;
+
+		switch (flushPolicy.type)
+		{
+		case FlushPolicy::Type::perCall:
+			this->flush();
+
+			break;
+
+		case FlushPolicy::Type::bytes:
+			if (unflushedBytes >= flushPolicy.threshold)
+			{
+				this->flush();
+			}
+
+			break;
+
+		case FlushPolicy::Type::interval:
+			if (std::chrono::steady_clock::now() - lastFlush >= flushPolicy.interval)
+			{
+				this->flush();
+			}
+
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	void WriteFileHandle::preallocate(uint64_t bytes)
+	{
+#ifdef __LINUX__
+		if (!preallocation.step || !(mode & std::ios_base::app) || !buffer.is_open())
 		{
 			return;
 		}
 
-		_utility::addCache(std::move(filePath), std::move(cacheData));
+		if (appendEnd == unknownEnd)
+		{
+			// Pending data is flushed first, appends go to the end regardless of position
+			std::streampos end = buffer.pubseekoff(0, std::ios_base::end, std::ios_base::out);
+
+			if (end == std::streampos(-1))
+			{
+				preallocation.step = 0;
+
+				return;
+			}
+
+			appendEnd = static_cast<uint64_t>(end);
+		}
+
+		node->preallocate(buffer.getDescriptor(), appendEnd, appendEnd + bytes, preallocation.step);
+
+		appendEnd += bytes;
+#endif
 	}
 
-	WriteFileHandle::WriteFileHandle(const std::filesystem::path& filePath, std::ios_base::openmode mode) :
-		FileHandle(filePath, mode | std::ios_base::out)
+	void WriteFileHandle::release()
 	{
+		if (!isNotifyOnDestruction)
+		{
+			return;
+		}
+
+		std::exception_ptr exception;
+		uint64_t ticket = 0;
+
+		file.flush();
+
+		buffer.close();
+
+		if (preallocation.isTrimmedOnClose && (mode & std::ios_base::app))
+		{
+			node->trimPreallocation();
+		}
+
+		try
+		{
+			switch (durability)
+			{
+			case Durability::dataSync:
+			case Durability::fullSync:
+				node->sync(durability == Durability::fullSync);
+
+				break;
+
+			case Durability::groupCommit:
+				ticket = node->joinGroupCommit();
+
+				break;
+
+			default:
+				break;
+			}
+		}
+		catch (...)
+		{
+			exception = std::current_exception();
+		}
+
+		if (ticket)
+		{
+			// Writers admitted by release must not wait for group commit on this thread
+			FileNode::HandoffScope scope(false);
+
+			FileHandle::release();
+		}
+		else
+		{
+			FileHandle::release();
+		}
+
+		if (exception)
+		{
+			std::rethrow_exception(exception);
+		}
 
+		if (ticket && !FileNode::GroupCommitScope::defer(node, ticket))
+		{
+			node->waitGroupCommit(ticket);
+		}
 	}
 
 	void WriteFileHandle::write(const std::string& data)
 	{
-		file.write(data.data(), data.size()).flush();
+		this->preallocate(data.size());
+
+		file.write(data.data(), data.size());
+
+		transferredBytes += data.size();
+
+		this->flushIfNeeded(data.size());
+	}
+
+	void WriteFileHandle::write(std::span<const std::string_view> buffers)
+	{
+		uint64_t writtenBytes = 0;
+
+		for (std::string_view data : buffers)
+		{
+			writtenBytes += data.size();
+		}
+
+		this->preallocate(writtenBytes);
+
+#ifdef __LINUX__
+		if (file && !buffer.writeVectored(buffers))
+		{
+			file.setstate(std::ios_base::badbit);
+		}
+#else
+		for (std::string_view data : buffers)
+		{
+			file.write(data.data(), data.size());
+		}
+#endif
+
+		transferredBytes += writtenBytes;
+
+		this->flushIfNeeded(writtenBytes);
+	}
+
+	void WriteFileHandle::write(std::initializer_list<std::string_view> buffers)
+	{
+		this->write(std::span<const std::string_view>(buffers.begin(), buffers.size()));
+	}
+
+	void WriteFileHandle::flush()
+	{
+		file.flush();
+
+		unflushedBytes = 0;
+
+		if (flushPolicy.type == FlushPolicy::Type::interval)
+		{
+			lastFlush = std::chrono::steady_clock::now();
+		}
+	}
+
+	void WriteFileHandle::setFlushPolicy(const FlushPolicy& flushPolicy)
+	{
+		this->flushPolicy = flushPolicy;
+
+		lastFlush = std::chrono::steady_clock::now();
+	}
+
+	const WriteFileHandle::FlushPolicy& WriteFileHandle::getFlushPolicy() const
+	{
+		return flushPolicy;
+	}
+
+	void WriteFileHandle::setDurability(Durability durability)
+	{
+		this->durability = durability;
+	}
+
+	WriteFileHandle::Durability WriteFileHandle::getDurability() const
+	{
+		return durability;
+	}
+
+	void WriteFileHandle::setPreallocation(const Preallocation& preallocation)
+	{
+		this->preallocation = preallocation;
+	}
+
+	const WriteFileHandle::Preallocation& WriteFileHandle::getPreallocation() const
+	{
+		return preallocation;
 	}
 
 	std::ostream& WriteFileHandle::getStream()
@@ -74,9 +465,13 @@ namespace file_manager
 
 	WriteFileHandle::~WriteFileHandle()
 	{
-		if (isNotifyOnDestruction)
+		try
+		{
+			this->release();
+		}
+		catch (const std::system_error&)
 		{
-			FileManager::getInstance().completeWriteRequest(filePath);
+			// Call release explicitly to get sync errors
 		}
 	}
 }
@@ -0,0 +1,322 @@
+#include "IoRing.h"
+
+#ifdef __LINUX__
+#include <atomic>
+#include <system_error>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <chrono>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+	/// @brief Operation that stops completion thread
+	constexpr uint64_t stopUserData = 0;
+
+	int setup(uint32_t entries, io_uring_params& parameters)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_setup, entries, &parameters));
+	}
+
+	int enter(int ringDescriptor, uint32_t toSubmit, uint32_t minComplete, uint32_t flags)
+	{
+		return static_cast<int>(syscall(__NR_io_uring_enter, ringDescriptor, toSubmit, minComplete, flags, nullptr, 0));
+	}
+
+	void* map(int ringDescriptor, size_t size, off_t offset)
+	{
+		void* result = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringDescriptor, offset);
+
+		if (result == MAP_FAILED)
+		{
+			throw std::system_error(errno, std::generic_category(), "io_uring mmap");
+		}
+
+		return result;
+	}
+
+	template<typename T>
+	T* at(void* ring, uint32_t offset)
+	{
+		return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+	}
+}
+
+namespace file_manager::_utility
+{
+	void IoRing::submit(uint8_t operationCode, Operation* operation, int descriptor, uint64_t address, uint32_t size, uint64_t offset)
+	{
+		if (std::this_thread::get_id() == completionThread.get_id())
+		{
+			isEntryReused = true;
+		}
+		else
+		{
+			availableEntries.acquire();
+		}
+
+		std::unique_lock<std::mutex> lock(submissionMutex);
+		uint32_t tail = *submissionQueue.tail;
+		uint32_t index = tail & submissionQueue.mask;
+		io_uring_sqe& entry = submissionEntries[index];
+
+		std::memset(&entry, 0, sizeof(entry));
+
+		entry.opcode = operationCode;
+		entry.fd = descriptor;
+		entry.addr = address;
+		entry.len = size;
+		entry.off = offset;
+		entry.user_data = reinterpret_cast<uint64_t>(operation);
+
+		submissionArray[index] = index;
+
+		std::atomic_ref<uint32_t>(*submissionQueue.tail).store(tail + 1, std::memory_order_release);
+
+		pendingSubmissions++;
+
+		if (isSubmitting)
+		{
+			return;
+		}
+
+		isSubmitting = true;
+
+		while (uint32_t toSubmit = std::exchange(pendingSubmissions, 0))
+		{
+			int error = 0;
+
+			lock.unlock();
+
+			while (toSubmit)
+			{
+				int submitted = enter(ringDescriptor, toSubmit, 0, 0);
+
+				if (submitted < 0)
+				{
+					if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+					{
+						continue;
+					}
+
+					error = errno;
+
+					break;
+				}
+
+				toSubmit -= static_cast<uint32_t>(submitted);
+			}
+
+			lock.lock();
+
+			if (error)
+			{
+				// Operations of other threads may be queued behind failed batch, they must not wait for submission that never happens
+				this->failUnsubmitted(lock, error);
+
+				return;
+			}
+		}
+
+		isSubmitting = false;
+	}
+
+	void IoRing::failUnsubmitted(std::unique_lock<std::mutex>& lock, int error)
+	{
+		uint32_t head = std::atomic_ref<uint32_t>(*submissionQueue.head).load(std::memory_order_acquire);
+		uint32_t tail = *submissionQueue.tail;
+		std::vector<Operation*> operations;
+
+		operations.reserve(tail - head);
+
+		for (uint32_t i = head; i != tail; i++)
+		{
+			operations.push_back(reinterpret_cast<Operation*>(submissionEntries[submissionArray[i & submissionQueue.mask]].user_data));
+		}
+
+		std::atomic_ref<uint32_t>(*submissionQueue.tail).store(head, std::memory_order_release);
+
+		pendingSubmissions = 0;
+		isSubmitting = false;
+
+		lock.unlock();
+
+		for (Operation* operation : operations)
+		{
+			// Stop operation has no owner, completion thread that can't wait stops on isStopping
+			if (!operation)
+			{
+				continue;
+			}
+
+			availableEntries.release();
+
+			operation->complete(-error);
+		}
+	}
+
+	void IoRing::reap()
+	{
+		io_uring_cqe* completions = static_cast<io_uring_cqe*>(completionEntries);
+		bool isWaitFailed = false;
+
+		while (true)
+		{
+			uint32_t head = *completionQueue.head;
+
+			if (head == std::atomic_ref<uint32_t>(*completionQueue.tail).load(std::memory_order_acquire))
+			{
+				if (isWaitFailed)
+				{
+					// Stop operation may be rejected too, nothing is in flight once destructor sets isStopping
+					if (isStopping.load(std::memory_order_acquire))
+					{
+						return;
+					}
+
+					// Kernel still posts completions to ring, so they are polled instead of waited for
+					std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				}
+				else if (enter(ringDescriptor, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				{
+					isWaitFailed = true;
+				}
+
+				continue;
+			}
+
+			const io_uring_cqe& completion = completions[head & completionQueue.mask];
+			uint64_t userData = completion.user_data;
+			int32_t result = completion.res;
+
+			std::atomic_ref<uint32_t>(*completionQueue.head).store(head + 1, std::memory_order_release);
+
+			if (userData == stopUserData)
+			{
+				return;
+			}
+
+			reinterpret_cast<Operation*>(userData)->complete(result);
+
+			if (!std::exchange(isEntryReused, false))
+			{
+				availableEntries.release();
+			}
+		}
+	}
+
+	void IoRing::close()
+	{
+		if (submissionEntries)
+		{
+			munmap(submissionEntries, submissionEntriesSize);
+		}
+
+		if (completionRing && completionRing != submissionRing)
+		{
+			munmap(completionRing, completionRingSize);
+		}
+
+		if (submissionRing)
+		{
+			munmap(submissionRing, submissionRingSize);
+		}
+
+		if (ringDescriptor != -1)
+		{
+			::close(ringDescriptor);
+		}
+	}
+
+	IoRing::IoRing(uint32_t entries) :
+		ringDescriptor(-1),
+		submissionRing(nullptr),
+		completionRing(nullptr),
+		submissionEntries(nullptr),
+		entries(entries),
+		pendingSubmissions(0),
+		isSubmitting(false),
+		isEntryReused(false),
+		isStopping(false),
+		availableEntries(entries)
+	{
+		io_uring_params parameters = {};
+
+		ringDescriptor = setup(entries, parameters);
+
+		if (ringDescriptor < 0)
+		{
+			throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+		}
+
+		try
+		{
+			submissionRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(uint32_t);
+			completionRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+
+			if (parameters.features & IORING_FEAT_SINGLE_MMAP)
+			{
+				submissionRingSize = completionRingSize = std::max(submissionRingSize, completionRingSize);
+			}
+
+			submissionRing = map(ringDescriptor, submissionRingSize, IORING_OFF_SQ_RING);
+			completionRing = (parameters.features & IORING_FEAT_SINGLE_MMAP) ?
+				submissionRing :
+				map(ringDescriptor, completionRingSize, IORING_OFF_CQ_RING);
+
+			submissionEntriesSize = parameters.sq_entries * sizeof(io_uring_sqe);
+			submissionEntries = static_cast<io_uring_sqe*>(map(ringDescriptor, submissionEntriesSize, IORING_OFF_SQES));
+		}
+		catch (...)
+		{
+			this->close();
+
+			throw;
+		}
+
+		submissionQueue = { at<uint32_t>(submissionRing, parameters.sq_off.head), at<uint32_t>(submissionRing, parameters.sq_off.tail), *at<uint32_t>(submissionRing, parameters.sq_off.ring_mask) };
+		submissionArray = at<uint32_t>(submissionRing, parameters.sq_off.array);
+		completionQueue = { at<uint32_t>(completionRing, parameters.cq_off.head), at<uint32_t>(completionRing, parameters.cq_off.tail), *at<uint32_t>(completionRing, parameters.cq_off.ring_mask) };
+		completionEntries = at<void>(completionRing, parameters.cq_off.cqes);
+
+		completionThread = std::thread(&IoRing::reap, this);
+	}
+
+	void IoRing::read(Operation* operation, int descriptor, void* buffer, uint32_t size, uint64_t offset)
+	{
+		this->submit(IORING_OP_READ, operation, descriptor, reinterpret_cast<uint64_t>(buffer), size, offset);
+	}
+
+	void IoRing::write(Operation* operation, int descriptor, const void* buffer, uint32_t size, uint64_t offset)
+	{
+		this->submit(IORING_OP_WRITE, operation, descriptor, reinterpret_cast<uint64_t>(buffer), size, offset);
+	}
+
+	IoRing::~IoRing()
+	{
+		if (completionThread.joinable())
+		{
+			// Taking all entries waits for operations in flight, then stop operation takes one back
+			for (uint32_t i = 0; i < entries; i++)
+			{
+				availableEntries.acquire();
+			}
+
+			availableEntries.release();
+
+			isStopping.store(true, std::memory_order_release);
+
+			this->submit(IORING_OP_NOP, nullptr, -1, 0, 0, 0);
+
+			completionThread.join();
+		}
+
+		this->close();
+	}
+}
+#endif
@@ -0,0 +1,214 @@
+#include "RequestArena.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <array>
+
+namespace
+{
+	constexpr size_t headerSize = alignof(std::max_align_t);
+	constexpr size_t sizeClassStep = 64;
+	constexpr size_t sizeClassesCount = file_manager::_utility::RequestArena::maxBlockSize / sizeClassStep;
+	constexpr size_t blocksPerChunk = 64;
+
+	struct Arena;
+
+	struct alignas(std::max_align_t) BlockHeader
+	{
+		Arena* owner;
+		size_t sizeClass;
+	};
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	struct Arena
+	{
+		std::array<FreeBlock*, sizeClassesCount> localBlocks{};
+		std::array<std::atomic<FreeBlock*>, sizeClassesCount> remoteBlocks{};
+		std::vector<void*> chunks;
+
+		void* allocate(size_t sizeClass);
+
+		void deallocate(FreeBlock* block, size_t sizeClass);
+
+		void deallocateRemote(FreeBlock* block, size_t sizeClass);
+	};
+
+	/// @brief Owns all arenas, they are never destroyed because blocks may outlive their threads
+	class ArenasRegistry
+	{
+	private:
+		std::vector<Arena*> arenas;
+		std::vector<Arena*> freeArenas;
+		std::mutex arenasMutex;
+
+	public:
+		Arena* acquire();
+
+		void release(Arena* arena);
+	};
+
+	class ThreadArena
+	{
+	public:
+		Arena* arena;
+
+	public:
+		ThreadArena();
+
+		~ThreadArena();
+	};
+
+	static_assert(sizeof(BlockHeader) == headerSize);
+
+	ArenasRegistry& getRegistry()
+	{
+		static ArenasRegistry* registry = new ArenasRegistry();
+
+		return *registry;
+	}
+
+	thread_local bool isThreadArenaDestroyed = false;
+
+	Arena* getThreadArena()
+	{
+		if (isThreadArenaDestroyed)
+		{
+			return nullptr;
+		}
+
+		thread_local ThreadArena threadArena;
+
+		return threadArena.arena;
+	}
+
+	void* Arena::allocate(size_t sizeClass)
+	{
+		FreeBlock*& blocks = localBlocks[sizeClass];
+
+		if (!blocks)
+		{
+			blocks = remoteBlocks[sizeClass].exchange(nullptr, std::memory_order_acquire);
+		}
+
+		if (!blocks)
+		{
+			size_t blockSize = headerSize + (sizeClass + 1) * sizeClassStep;
+			char* chunk = static_cast<char*>(::operator new(blockSize * blocksPerChunk));
+
+			chunks.push_back(chunk);
+
+			for (size_t i = 0; i < blocksPerChunk; i++)
+			{
+				BlockHeader* header = new (chunk + i * blockSize) BlockHeader{ this, sizeClass };
+
+				this->deallocate(reinterpret_cast<FreeBlock*>(reinterpret_cast<char*>(header) + headerSize), sizeClass);
+			}
+		}
+
+		FreeBlock* result = blocks;
+
+		blocks = result->next;
+
+		return result;
+	}
+
+	void Arena::deallocate(FreeBlock* block, size_t sizeClass)
+	{
+		block->next = localBlocks[sizeClass];
+		localBlocks[sizeClass] = block;
+	}
+
+	void Arena::deallocateRemote(FreeBlock* block, size_t sizeClass)
+	{
+		std::atomic<FreeBlock*>& blocks = remoteBlocks[sizeClass];
+
+		block->next = blocks.load(std::memory_order_relaxed);
+
+		while (!blocks.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed));
+	}
+
+	Arena* ArenasRegistry::acquire()
+	{
+		std::lock_guard<std::mutex> lock(arenasMutex);
+
+		if (freeArenas.size())
+		{
+			Arena* result = freeArenas.back();
+
+			freeArenas.pop_back();
+
+			return result;
+		}
+
+		return arenas.emplace_back(new Arena());
+	}
+
+	void ArenasRegistry::release(Arena* arena)
+	{
+		std::lock_guard<std::mutex> lock(arenasMutex);
+
+		freeArenas.push_back(arena);
+	}
+
+	ThreadArena::ThreadArena() :
+		arena(getRegistry().acquire())
+	{
+
+	}
+
+	ThreadArena::~ThreadArena()
+	{
+		isThreadArenaDestroyed = true;
+
+		getRegistry().release(arena);
+	}
+}
+
+namespace file_manager::_utility
+{
+	void* RequestArena::allocate(size_t size)
+	{
+		Arena* arena = size && size <= maxBlockSize ? getThreadArena() : nullptr;
+
+		if (!arena)
+		{
+			BlockHeader* header = new (::operator new(headerSize + size)) BlockHeader{ nullptr, 0 };
+
+			return reinterpret_cast<char*>(header) + headerSize;
+		}
+
+		return arena->allocate((size - 1) / sizeClassStep);
+	}
+
+	void RequestArena::deallocate(void* block) noexcept
+	{
+		if (!block)
+		{
+			return;
+		}
+
+		BlockHeader* header = reinterpret_cast<BlockHeader*>(static_cast<char*>(block) - headerSize);
+		Arena* owner = header->owner;
+
+		if (!owner)
+		{
+			::operator delete(header);
+
+			return;
+		}
+
+		if (owner == getThreadArena())
+		{
+			owner->deallocate(static_cast<FreeBlock*>(block), header->sizeClass);
+		}
+		else
+		{
+			owner->deallocateRemote(static_cast<FreeBlock*>(block), header->sizeClass);
+		}
+	}
+}
@@ -1,14 +1,23 @@
 #include "Utility.h"
 
+#include <sstream>
+
 #include "FileManager.h"
 
+#ifdef __LINUX__
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#include <Windows.h>
+#endif
+
 namespace file_manager
 {
 	namespace utility
 	{
 		size_t PathHash::operator () (const std::filesystem::path& filePath) const noexcept
 		{
-			return std::hash<std::string>()(filePath.string());
+			return std::hash<std::filesystem::path::string_type>()(filePath.native());
 		}
 	}
 
@@ -19,12 +28,80 @@ namespace file_manager
 			Cache& cache = FileManager::getInstance().getCache();
 			std::lock_guard<std::mutex> lock(cache.cacheDataMutex);
 
-			if (cache.currentCacheSize + data.size() > cache.cacheSize)
+			// Readers of previous data keep it alive
+			if (auto it = cache.index.find(filePath); it != cache.index.end())
 			{
+				cache.remove(it->second);
+			}
+
+			// Size of data is already reserved with changeCurrentCacheSize, now it belongs to entry
+			cache.reservedCacheSize -= data.size();
+			cache.invalidations++;
+
+			cache.insert(filePath, std::make_shared<std::string>(std::move(data)));
+		}
+
+		void syncFile(const std::filesystem::path& filePath, bool isFull)
+		{
+#ifdef __LINUX__
+			int descriptor = open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+			if (descriptor == -1)
+			{
+				throw std::system_error(errno, std::generic_category(), filePath.string());
+			}
+
+			// fdatasync and fsync flush file regardless of descriptor access mode
+			int result = isFull ? fsync(descriptor) : fdatasync(descriptor);
+			int error = errno;
+
+			close(descriptor);
+
+			if (result)
+			{
+				throw std::system_error(error, std::generic_category(), filePath.string());
+			}
+#else
+			// FlushFileBuffers needs write access and always flushes metadata
+			HANDLE file = CreateFileW(filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+			if (file == INVALID_HANDLE_VALUE)
+			{
+				throw std::system_error(GetLastError(), std::system_category(), filePath.string());
+			}
+
+			BOOL result = FlushFileBuffers(file);
+			DWORD error = GetLastError();
+
+			CloseHandle(file);
+
+			if (!result)
+			{
+				throw std::system_error(error, std::system_category(), filePath.string());
+			}
+#endif
+		}
+
+		void readAll(std::istream& stream, std::string& outData)
+		{
+			std::istream::pos_type start = stream.tellg();
+			std::istream::pos_type end = stream.seekg(0, std::ios_base::end).tellg();
+
+			stream.seekg(start);
+
+			if (start == std::istream::pos_type(-1) || end == std::istream::pos_type(-1) || end <= start)
+			{
+				stream.clear();
+
+				outData = (std::ostringstream() << stream.rdbuf()).str();
+
 				return;
 			}
 
-			cache.cacheData.try_emplace(std::move(filePath), std::move(data));
+			outData.resize(static_cast<size_t>(end - start));
+
+			// Text mode conversion can make data shorter than its size in file
+			outData.resize(static_cast<size_t>(stream.read(outData.data(), outData.size()).gcount()));
 		}
 	}
 }